@@ -0,0 +1,231 @@
+#!/usr/bin/env python3
+"""Measures how the cost of compiling khct code scales with the size of its inputs.
+
+For every case and size a translation unit is generated and compiled on its own. Wall time and peak RSS of the
+compiler are measured for each compile; with Clang the template instantiations are counted from -ftime-trace and with
+GCC the time spent instantiating templates is read from -ftime-report. The results are written as CSV.
+"""
+
+import argparse
+import csv
+import json
+import os
+import re
+import signal
+import subprocess
+import sys
+import tempfile
+import threading
+import time
+
+
+def json_object(size):
+    members = ', '.join(f'"key{i}": {i}' for i in range(size))
+    return '#include "khct/json.hpp"\n' f'constexpr auto value = khct::parse_json<R"({{{members}}})">();\n'
+
+
+def json_array(size):
+    elements = ', '.join(str(i) for i in range(size))
+    return '#include "khct/json.hpp"\n' f'constexpr auto value = khct::parse_json<R"([{elements}])">();\n'
+
+
+def json_depth(size):
+    return '#include "khct/json.hpp"\n' f'constexpr auto value = khct::parse_json<R"({"[" * size}{"]" * size})">();\n'
+
+
+def json_array_get(size):
+    elements = ', '.join(str(i) for i in range(size))
+    return ('#include "khct/json.hpp"\n' f'constexpr auto value = khct::parse_json<R"([{elements}])">();\n'
+            f'static_assert(value.get<{size - 1}>() == {size - 1});\n')
+
+
+def config_document(size):
+    sections = (f'"section{i}": {{"name": "s{i}", "values": [{i}, {i + 1}, {i + 2}]}}' for i in range(size))
+    return '{' + ', '.join(sections) + '}'
+
+
+def json_pointer_at(size):
+    return ('#include "khct/json.hpp"\n' f'constexpr auto value = khct::parse_json<R"({config_document(size)})">();\n'
+            f'static_assert(khct::at<"/section{size - 1}/values/2">(value) == {size + 1});\n')
+
+
+def parse_json_at(size):
+    return ('#include "khct/json.hpp"\n'
+            f'static_assert(khct::parse_json_at<R"({config_document(size)})", "/section{size - 1}/values/2">() == '
+            f'{size + 1});\n')
+
+
+def parse_json_lazy(size):
+    reads = ''.join(f'static_assert(khct::at<"/name">(doc.get<"section{i}">()) == khct::string{{"s{i}"}});\n'
+                    for i in range(0, size, max(size // 4, 1)))
+    return ('#include "khct/json.hpp"\n'
+            f'constexpr auto doc = khct::parse_json_lazy<R"({config_document(size)})">();\n' + reads)
+
+
+def json_document(size):
+    return ('#include "khct/json.hpp"\n'
+            f'constexpr auto doc = khct::make_json_document<R"({config_document(size)})">();\n'
+            f'static_assert((*(*doc.root()["section{size - 1}"])["values"])[2]->as_unsigned() == {size + 1});\n')
+
+
+def json_doubles(size):
+    elements = ', '.join(f'{i + 1}.{i * 7919 % 100000:05}e{i % 600 - 300}' for i in range(size))
+    return ('#include "khct/json.hpp"\n' f'constexpr auto value = khct::parse_json<R"([{elements}])">();\n'
+            f'static_assert(value.get<0>() == 1.0e-300);\n')
+
+
+def tuple_get(size):
+    types = ', '.join('int' for _ in range(size))
+    values = ', '.join(str(i) for i in range(size))
+    return ('#include "khct/common.hpp"\n' f'constexpr auto value = khct::tuple<{types}>{{{values}}};\n'
+            f'static_assert(value.get<{size - 1}>() == {size - 1} && value.get<0>() == 0);\n')
+
+
+def split(size):
+    fields = ','.join(f'field{i}' for i in range(size))
+    return '#include "khct/string.hpp"\n' f'constexpr auto value = khct::split<khct::string{{"{fields}"}}, \',\'>();\n'
+
+
+def make_map(size):
+    pairs = ', '.join(f'{{{i * 7 % size}, {i}}}' for i in range(size))
+    return '#include "khct/map.hpp"\n' f'constexpr auto value = khct::make_map<int, int>({{{pairs}}});\n'
+
+
+def merge_maps(size):
+    # Every other key of the second map is also in the first
+    lhs = ', '.join(f'{{{i * 2}, {i}}}' for i in range(size))
+    rhs = ', '.join(f'{{{i * 4}, {i}}}' for i in range(size))
+    return ('#include "khct/map.hpp"\n' f'constexpr auto lhs = khct::make_map<int, int>({{{lhs}}});\n'
+            f'constexpr auto rhs = khct::make_map<int, int>({{{rhs}}});\n'
+            'constexpr auto value = khct::merge<lhs, rhs>(khct::keep_right);\n')
+
+
+def make_multi_type_map(size):
+    pairs = ', '.join(f'{{{i}, {i if i % 2 else str(i) + ".5"}}}' for i in range(size))
+    return '#include "khct/map.hpp"\n' f'constexpr auto value = khct::make_multi_type_map<{pairs}>();\n'
+
+
+def multi_type_map_get(size):
+    gets = ' + '.join(f'int(value.get<{i}>())' for i in range(size))
+    return make_multi_type_map(size) + f'constexpr auto sum = {gets};\n'
+
+
+CASES = {
+    'json_object': json_object,
+    'json_array': json_array,
+    'json_depth': json_depth,
+    'json_array_get': json_array_get,
+    'json_doubles': json_doubles,
+    'json_pointer_at': json_pointer_at,
+    'parse_json_at': parse_json_at,
+    'parse_json_lazy': parse_json_lazy,
+    'json_document': json_document,
+    'tuple_get': tuple_get,
+    'split': split,
+    'make_map': make_map,
+    'merge_maps': merge_maps,
+    'make_multi_type_map': make_multi_type_map,
+    'multi_type_map_get': multi_type_map_get,
+}
+
+DEFAULT_SIZES = (8, 16, 32, 64, 128, 256)
+
+# Cases whose cost no longer grows with recursion depth are also run at sizes the others can't reach
+LARGE_SIZES = {
+    'tuple_get': (1000, 5000),
+    'json_array_get': (1000, 5000),
+}
+
+
+def is_clang(compiler):
+    output = subprocess.run([compiler, '--version'], capture_output=True, text=True).stdout
+    return 'clang' in output
+
+
+def count_instantiations(trace_file):
+    with open(trace_file) as f:
+        events = json.load(f)['traceEvents']
+    return sum(1 for event in events if event.get('name') in ('InstantiateClass', 'InstantiateFunction'))
+
+
+def instantiation_seconds(time_report):
+    # e.g. " template instantiation   :   0.33 ( 23%)   0.07 ( 10%)   0.46 ( 21%)    34M ( 22%)" (usr, sys, wall, mem)
+    time_column = r'(\d+\.\d+)\s*\(\s*\d+%\)\s*'
+    match = re.search(r'template instantiation\s*:\s*' + time_column * 3, time_report)
+    return match.group(3) if match else ''
+
+
+def compile_case(compiler, clang, include_dir, extra_flags, source, work_dir, timeout):
+    source_file = os.path.join(work_dir, 'case.cpp')
+    with open(source_file, 'w') as f:
+        f.write(source)
+        f.write('\nint main() {}\n')
+    object_file = os.path.join(work_dir, 'case.o')
+    command = [compiler, '-std=c++20', f'-I{include_dir}', '-c', source_file, '-o', object_file, *extra_flags]
+    command += ['-ftime-trace', '-ftime-trace-granularity=0'] if clang else ['-ftime-report']
+
+    stderr_file = os.path.join(work_dir, 'stderr.txt')
+    with open(stderr_file, 'w') as stderr:
+        start = time.monotonic()
+        process = subprocess.Popen(command, stdout=subprocess.DEVNULL, stderr=stderr)
+        timer = threading.Timer(timeout, process.kill)
+        timer.start()
+        # The usage returned by wait4 covers the driver and the compiler it waited for
+        _, status, usage = os.wait4(process.pid, 0)
+        wall = time.monotonic() - start
+        timer.cancel()
+    returncode = os.waitstatus_to_exitcode(status)
+    with open(stderr_file) as f:
+        stderr = f.read()
+
+    if returncode == 0:
+        status = 'ok'
+    elif returncode == -signal.SIGKILL and wall >= timeout:
+        status = 'timeout'
+    else:
+        status = 'error'
+    result = {'status': status, 'wall_s': f'{wall:.3f}', 'peak_rss_kb': usage.ru_maxrss}
+    if clang:
+        trace_file = os.path.splitext(object_file)[0] + '.json'
+        if status == 'ok' and os.path.exists(trace_file):
+            result['instantiations'] = count_instantiations(trace_file)
+    else:
+        result['instantiation_s'] = instantiation_seconds(stderr)
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--compiler', action='append', required=True, help='may be given more than once')
+    parser.add_argument('--include-dir', required=True)
+    parser.add_argument('--cases', default=','.join(CASES), help='comma separated subset of: ' + ', '.join(CASES))
+    large_sizes = '; '.join(f'{case} also {",".join(map(str, sizes))}' for case, sizes in LARGE_SIZES.items())
+    parser.add_argument(
+        '--sizes', help=f'comma separated; defaults to {",".join(map(str, DEFAULT_SIZES))} ({large_sizes})')
+    parser.add_argument('--timeout', type=float, default=300, help='seconds allowed per compile')
+    parser.add_argument('--extra-flag', action='append', default=[], help='passed to every compile')
+    parser.add_argument('--output', help='CSV file to write; defaults to stdout')
+    args = parser.parse_args()
+
+    fields = ['compiler', 'case', 'size', 'status', 'wall_s', 'peak_rss_kb', 'instantiations', 'instantiation_s']
+    output = open(args.output, 'w', newline='') if args.output else sys.stdout
+    writer = csv.DictWriter(output, fieldnames=fields, restval='')
+    writer.writeheader()
+    for compiler in args.compiler:
+        clang = is_clang(compiler)
+        for case in args.cases.split(','):
+            if args.sizes:
+                sizes = [int(size) for size in args.sizes.split(',')]
+            else:
+                sizes = [*DEFAULT_SIZES, *LARGE_SIZES.get(case, ())]
+            for size in sizes:
+                with tempfile.TemporaryDirectory() as work_dir:
+                    source = CASES[case](size)
+                    result = compile_case(
+                        compiler, clang, args.include_dir, args.extra_flag, source, work_dir, args.timeout)
+                writer.writerow({'compiler': compiler, 'case': case, 'size': size, **result})
+                output.flush()
+
+
+if __name__ == '__main__':
+    main()
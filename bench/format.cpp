@@ -0,0 +1,65 @@
+#include "khct/format.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace khct;
+
+namespace {
+
+constexpr std::size_t line_count = 1 << 12;
+constexpr int repetitions = 256;
+
+struct request {
+   std::uint64_t id;
+   std::int64_t micros;
+   std::string path;
+};
+
+std::vector<request> make_requests()
+{
+   std::mt19937 rng{42};
+   std::uniform_int_distribution<int> dist{0, 1'000'000};
+   std::vector<request> to_ret(line_count);
+   for (std::size_t i = 0; i < line_count; ++i) {
+      const auto value = dist(rng);
+      to_ret[i] = {i, value, "/api/v1/items/" + std::to_string(value % 1000)};
+   }
+   return to_ret;
+}
+
+template<typename Format>
+void run(const char* name, const std::vector<request>& requests, Format format_request)
+{
+   std::size_t bytes = 0;
+   const auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < repetitions; ++i) {
+      for (const auto& req : requests) {
+         bytes += format_request(req);
+      }
+   }
+   const auto end = std::chrono::steady_clock::now();
+   const auto seconds = std::chrono::duration<double>(end - start).count();
+   std::printf("%s,%.2f,%.1f\n", name, requests.size() * repetitions / seconds / 1e6, bytes / seconds / 1e6);
+}
+
+} // namespace
+
+int main()
+{
+   const auto requests = make_requests();
+   char buffer[256];
+   std::puts("formatter,million_lines_per_s,mb_per_s");
+   run("khct::format", requests, [&](const request& req) {
+      return format<"req {} {} took {}us">(buffer, req.id, req.path, req.micros).value_or(0);
+   });
+   run("snprintf", requests, [&](const request& req) {
+      return static_cast<std::size_t>(std::snprintf(buffer, sizeof(buffer), "req %llu %s took %lldus",
+                                                    static_cast<unsigned long long>(req.id), req.path.c_str(),
+                                                    static_cast<long long>(req.micros)));
+   });
+}
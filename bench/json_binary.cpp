@@ -0,0 +1,110 @@
+#include "khct/json.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iterator>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace khct;
+
+namespace {
+
+constexpr std::size_t member_count = 1024;
+constexpr std::size_t lookup_count = 1 << 16;
+constexpr int repetitions = 16;
+
+// Writes an object of members like "key12": [12, "name12", {"value": 12}] to out unless it's null, giving the number
+// of characters
+constexpr std::size_t write_document_text(char* out)
+{
+   std::size_t size = 0;
+   const auto put = [&](std::string_view text) {
+      if (out != nullptr) {
+         std::ranges::copy(text, out + size);
+      }
+      size += text.size();
+   };
+   for (std::size_t i = 0; i < member_count; ++i) {
+      char digits[20];
+      auto first = std::end(digits);
+      for (auto value = i; first == std::end(digits) || value != 0; value /= 10) {
+         *--first = static_cast<char>('0' + value % 10);
+      }
+      const auto number = std::string_view{first, std::end(digits)};
+      put(i == 0 ? "{\"key" : ",\"key");
+      put(number);
+      put("\": [");
+      put(number);
+      put(", \"name");
+      put(number);
+      put("\", {\"value\": ");
+      put(number);
+      put("}]");
+   }
+   put("}");
+   return size;
+}
+
+constexpr auto document_text = []() consteval {
+   string<write_document_text(nullptr) + 1> to_ret;
+   write_document_text(to_ret.begin());
+   return to_ret;
+}();
+
+constexpr auto binary = make_json_binary<document_text>();
+
+std::vector<std::string> make_lookups()
+{
+   std::mt19937 rng{42};
+   std::uniform_int_distribution<std::size_t> dist{0, member_count - 1};
+   std::vector<std::string> to_ret(lookup_count);
+   for (auto& lookup : to_ret) {
+      lookup = "key" + std::to_string(dist(rng));
+   }
+   return to_ret;
+}
+
+// Reads /<key>/2/value
+template<typename Value>
+std::uint64_t read(const Value& root, std::string_view key)
+{
+   return *(*(*root[key])[2])["value"]->as_unsigned();
+}
+
+template<typename Value>
+void run(const char* name, double setup_seconds, const std::vector<std::string>& lookups, const Value& root)
+{
+   std::uint64_t sum = 0;
+   const auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < repetitions; ++i) {
+      for (const auto& lookup : lookups) {
+         sum += read(root, lookup);
+      }
+   }
+   const auto end = std::chrono::steady_clock::now();
+   const auto seconds = std::chrono::duration<double>(end - start).count();
+   std::printf(
+      "%s,%.1f,%.2f,%llu\n",
+      name,
+      setup_seconds * 1e6,
+      lookups.size() * repetitions / seconds / 1e6,
+      static_cast<unsigned long long>(sum / repetitions));
+}
+
+} // namespace
+
+int main()
+{
+   const auto lookups = make_lookups();
+   std::puts("reader,setup_us,million_lookups_per_s,checksum");
+   run("khct::json_binary", 0, lookups, binary.root());
+   const auto start = std::chrono::steady_clock::now();
+   const json_dom dom{std::string_view{document_text.begin(), document_text.size()}};
+   const auto end = std::chrono::steady_clock::now();
+   run("khct::json_dom", std::chrono::duration<double>(end - start).count(), lookups, dom.root());
+   std::printf("binary_bytes,%zu\ntext_bytes,%zu\n", binary.bytes.size(), document_text.size());
+}
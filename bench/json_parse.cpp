@@ -0,0 +1,68 @@
+#include "khct/json.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+
+using namespace khct;
+
+namespace {
+
+constexpr std::size_t document_size = 1 << 24;
+constexpr int repetitions = 10;
+
+// An array of records like {"id": 12, "name": "item12", "price": 3.25, "tags": ["a", "b"], "active": true}
+std::string make_records(std::mt19937& rng)
+{
+   std::uniform_int_distribution<int> dist{0, 1'000'000};
+   std::string to_ret = "[";
+   for (int i = 0; to_ret.size() < document_size; ++i) {
+      const auto value = dist(rng);
+      to_ret += i == 0 ? "\n  " : ",\n  ";
+      to_ret += R"({"id": )" + std::to_string(i) + R"(, "name": "item)" + std::to_string(value) + R"(", "price": )"
+              + std::to_string(value / 100) + "." + std::to_string(value % 100) + R"(e-1, "tags": ["a", "b"], )"
+              + R"("active": )" + (value % 2 == 0 ? "true" : "false") + "}";
+   }
+   return to_ret + "\n]";
+}
+
+// One long array of integers
+std::string make_numbers(std::mt19937& rng)
+{
+   std::uniform_int_distribution<std::int64_t> dist{-1'000'000'000, 1'000'000'000};
+   std::string to_ret = "[";
+   while (to_ret.size() < document_size) {
+      to_ret += std::to_string(dist(rng)) + ",";
+   }
+   to_ret.back() = ']';
+   return to_ret;
+}
+
+void run(const char* name, const std::string& document)
+{
+   json_dom dom;
+   // The first parse grows the buffer so the timed ones don't allocate
+   if (dom.parse(document) != json_status::ok) {
+      std::printf("%s,failed to parse\n", name);
+      return;
+   }
+   const auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < repetitions; ++i) {
+      dom.parse(document);
+   }
+   const auto end = std::chrono::steady_clock::now();
+   const auto seconds = std::chrono::duration<double>(end - start).count();
+   std::printf("%s,%.1f\n", name, document.size() * repetitions / seconds / 1e6);
+}
+
+} // namespace
+
+int main()
+{
+   std::mt19937 rng{42};
+   std::puts("document,mb_per_s");
+   run("records", make_records(rng));
+   run("numbers", make_numbers(rng));
+}
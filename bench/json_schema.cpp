@@ -0,0 +1,170 @@
+#include "khct/json_schema.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
+using namespace khct;
+
+namespace {
+
+// Few enough messages to stay in cache, which are read repeatedly
+constexpr std::size_t message_count = 1 << 12;
+constexpr int repetitions = 256;
+
+constexpr string message_schema
+   = R"({"id": 0, "user": "", "price": 0.0, "quantity": 0, "buy": false, "venue": {"id": 0, "name": ""}})";
+
+std::vector<std::string> make_messages()
+{
+   std::mt19937 rng{42};
+   std::uniform_int_distribution<int> dist{0, 1'000'000};
+   std::vector<std::string> to_ret(message_count);
+   for (std::size_t i = 0; i < message_count; ++i) {
+      const auto value = dist(rng);
+      to_ret[i] = R"({"id": )" + std::to_string(i) + R"(, "user": "user)" + std::to_string(value % 1000)
+                + R"(", "price": )" + std::to_string(value / 100) + "." + std::to_string(value % 100)
+                + R"(, "quantity": )" + std::to_string(value % 500) + R"(, "buy": )"
+                + (value % 2 == 0 ? "true" : "false") + R"(, "venue": {"id": )" + std::to_string(value % 7)
+                + R"(, "name": "venue"}})";
+   }
+   return to_ret;
+}
+
+template<typename Read>
+void run(const char* name, const std::vector<std::string>& messages, Read read)
+{
+   std::uint64_t sum = 0;
+   const auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < repetitions; ++i) {
+      for (const auto& message : messages) {
+         sum += read(message);
+      }
+   }
+   const auto end = std::chrono::steady_clock::now();
+   const auto seconds = std::chrono::duration<double>(end - start).count();
+   const auto millions_per_second = messages.size() * repetitions / seconds / 1e6;
+   std::printf("%s,%.2f,%llu\n", name, millions_per_second, static_cast<unsigned long long>(sum));
+}
+
+// What a serializer that doesn't know the shape of the document works with
+struct generic_value;
+using generic_object = std::vector<std::pair<std::string, generic_value>>;
+struct generic_value {
+   std::variant<std::uint64_t, double, bool, std::string, generic_object> value;
+};
+
+void append_escaped(std::string& out, const std::string& str)
+{
+   out += '"';
+   for (const auto c : str) {
+      if (c == '"' || c == '\\') {
+         out += '\\';
+      }
+      out += c;
+   }
+   out += '"';
+}
+
+void append_generic(std::string& out, const generic_value& value)
+{
+   char digits[32];
+   if (const auto num = std::get_if<std::uint64_t>(&value.value)) {
+      out.append(digits, std::to_chars(digits, std::end(digits), *num).ptr);
+   }
+   else if (const auto num = std::get_if<double>(&value.value)) {
+      out.append(digits, std::to_chars(digits, std::end(digits), *num).ptr);
+   }
+   else if (const auto b = std::get_if<bool>(&value.value)) {
+      out += *b ? "true" : "false";
+   }
+   else if (const auto str = std::get_if<std::string>(&value.value)) {
+      append_escaped(out, *str);
+   }
+   else {
+      out += '{';
+      for (const auto& [name, member] : std::get<generic_object>(value.value)) {
+         if (out.back() != '{') {
+            out += ',';
+         }
+         append_escaped(out, name);
+         out += ':';
+         append_generic(out, member);
+      }
+      out += '}';
+   }
+}
+
+template<typename Write>
+void run_writer(const char* name, std::size_t count, Write write)
+{
+   std::size_t bytes = 0;
+   const auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < repetitions; ++i) {
+      for (std::size_t j = 0; j < count; ++j) {
+         bytes += write(j);
+      }
+   }
+   const auto end = std::chrono::steady_clock::now();
+   const auto seconds = std::chrono::duration<double>(end - start).count();
+   std::printf("%s,%.1f\n", name, bytes / seconds / 1e6);
+}
+
+} // namespace
+
+int main()
+{
+   const auto messages = make_messages();
+   std::puts("reader,million_messages_per_s,checksum");
+   run("read_json", messages, [](const std::string& message) {
+      json_schema_t<message_schema> to_read;
+      if (read_json<message_schema>(message, to_read) != json_status::ok) {
+         return std::uint64_t{0};
+      }
+      return to_read.get<"quantity">() + to_read.get<"venue">().get<"id">()
+           + static_cast<std::uint64_t>(to_read.get<"price">());
+   });
+   json_dom dom;
+   run("json_dom", messages, [&](const std::string& message) {
+      if (dom.parse(message) != json_status::ok) {
+         return std::uint64_t{0};
+      }
+      const auto root = dom.root();
+      return *root["quantity"]->as_unsigned() + *(*root["venue"])["id"]->as_unsigned()
+           + static_cast<std::uint64_t>(*root["price"]->as_double());
+   });
+
+   std::vector<json_schema_t<message_schema>> records(messages.size());
+   std::vector<generic_value> generic_records(messages.size());
+   for (std::size_t i = 0; i < messages.size(); ++i) {
+      auto& record = records[i];
+      read_json<message_schema>(messages[i], record);
+      generic_records[i].value = generic_object{
+         {"id", {record.get<"id">()}},
+         {"user", {std::string{record.get<"user">()}}},
+         {"price", {record.get<"price">()}},
+         {"quantity", {record.get<"quantity">()}},
+         {"buy", {record.get<"buy">()}},
+         {"venue",
+          {generic_object{
+             {"id", {record.get<"venue">().get<"id">()}},
+             {"name", {std::string{record.get<"venue">().get<"name">()}}}}}}};
+   }
+   std::puts("writer,mb_per_s");
+   char buffer[512];
+   run_writer("write_json", records.size(), [&](std::size_t i) {
+      return write_json<message_schema>(records[i], buffer).value_or(0);
+   });
+   std::string generic_buffer;
+   run_writer("generic", generic_records.size(), [&](std::size_t i) {
+      generic_buffer.clear();
+      append_generic(generic_buffer, generic_records[i]);
+      return generic_buffer.size();
+   });
+}
@@ -0,0 +1,64 @@
+#include "khct/map.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <span>
+#include <vector>
+
+using namespace khct;
+
+namespace {
+
+constexpr std::size_t lookup_count = 1 << 22;
+
+// map can only be constructed at compile time, which isn't feasible for the larger sizes; the layout storage that
+// map inherits its lookups from is used directly instead
+template<typename Layout, std::size_t Size>
+double time_lookups(const std::vector<std::uint32_t>& keys_to_find)
+{
+   using storage = Layout::template storage<std::uint32_t, std::uint32_t, Size, std::less<void>>;
+   std::vector<std::pair<std::uint32_t, std::uint32_t>> sorted(Size);
+   for (std::uint32_t i = 0; i < Size; ++i) {
+      sorted[i] = {i * 2, i};
+   }
+   const auto table = std::make_unique<storage>(std::span<const std::pair<std::uint32_t, std::uint32_t>, Size>{
+      sorted.data(), Size});
+
+   std::uint64_t sum = 0;
+   const auto start = std::chrono::steady_clock::now();
+   for (const auto key : keys_to_find) {
+      sum += (*table)[key].value_or(1);
+   }
+   const auto end = std::chrono::steady_clock::now();
+   if (sum == 0) {
+      std::puts("");
+   }
+   return std::chrono::duration<double, std::nano>(end - start).count() / keys_to_find.size();
+}
+
+template<std::size_t Size>
+void run()
+{
+   std::mt19937 rng{Size};
+   // Half of the lookups are misses
+   std::uniform_int_distribution<std::uint32_t> dist{0, Size * 2 - 1};
+   std::vector<std::uint32_t> keys_to_find(lookup_count);
+   for (auto& key : keys_to_find) {
+      key = dist(rng);
+   }
+   std::printf("%zu,sorted,%.2f\n", Size, time_lookups<sorted_layout, Size>(keys_to_find));
+   std::printf("%zu,eytzinger,%.2f\n", Size, time_lookups<eytzinger_layout, Size>(keys_to_find));
+}
+
+} // namespace
+
+int main()
+{
+   std::puts("entries,layout,ns_per_lookup");
+   run<1 << 10>();
+   run<1 << 16>();
+   run<1 << 20>();
+}
@@ -0,0 +1,68 @@
+#include "khct/regex.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <regex>
+#include <string>
+#include <vector>
+
+using namespace khct;
+
+namespace {
+
+constexpr std::size_t identifier_count = 1 << 14;
+constexpr int repetitions = 64;
+
+// A mix of valid identifiers and ones with a bad first character or a bad character in the middle
+std::vector<std::string> make_identifiers()
+{
+   std::mt19937 rng{42};
+   std::uniform_int_distribution<int> length{1, 24};
+   std::uniform_int_distribution<int> letter{0, 25};
+   std::uniform_int_distribution<int> kind{0, 9};
+   std::vector<std::string> to_ret(identifier_count);
+   for (auto& identifier : to_ret) {
+      const auto size = length(rng);
+      for (int i = 0; i < size; ++i) {
+         identifier += static_cast<char>('a' + letter(rng));
+      }
+      if (kind(rng) == 0) {
+         identifier.front() = '7';
+      }
+      else if (kind(rng) == 1) {
+         identifier[identifier.size() / 2] = '-';
+      }
+   }
+   return to_ret;
+}
+
+template<typename Match>
+void run(const char* name, const std::vector<std::string>& identifiers, Match match)
+{
+   std::size_t matches = 0;
+   const auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < repetitions; ++i) {
+      for (const auto& identifier : identifiers) {
+         matches += match(identifier);
+      }
+   }
+   const auto end = std::chrono::steady_clock::now();
+   const auto seconds = std::chrono::duration<double>(end - start).count();
+   std::printf("%s,%.2f,%zu\n", name, identifiers.size() * repetitions / seconds / 1e6, matches / repetitions);
+}
+
+} // namespace
+
+int main()
+{
+   const auto identifiers = make_identifiers();
+   std::puts("matcher,million_matches_per_s,matched");
+   run("khct::regex", identifiers, [](const std::string& identifier) {
+      return regex<"[A-Za-z_][A-Za-z0-9_]*">::match(identifier);
+   });
+   const std::regex runtime_regex{"[A-Za-z_][A-Za-z0-9_]*", std::regex::optimize};
+   run("std::regex", identifiers, [&](const std::string& identifier) {
+      return std::regex_match(identifier, runtime_regex);
+   });
+}
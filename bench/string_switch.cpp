@@ -0,0 +1,108 @@
+#include "khct/hash.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace khct;
+
+namespace {
+
+constexpr std::size_t lookup_count = 1 << 16;
+constexpr int repetitions = 64;
+
+using commands = string_switch<
+   "get",
+   "set",
+   "delete",
+   "exists",
+   "expire",
+   "increment",
+   "decrement",
+   "append",
+   "prepend",
+   "subscribe",
+   "unsubscribe",
+   "publish",
+   "ping",
+   "echo",
+   "flush",
+   "shutdown">;
+
+constexpr std::string_view names[]{
+   "get",
+   "set",
+   "delete",
+   "exists",
+   "expire",
+   "increment",
+   "decrement",
+   "append",
+   "prepend",
+   "subscribe",
+   "unsubscribe",
+   "publish",
+   "ping",
+   "echo",
+   "flush",
+   "shutdown"};
+
+// Mostly known commands with some unknown ones mixed in
+std::vector<std::string> make_lookups()
+{
+   std::mt19937 rng{42};
+   std::uniform_int_distribution<std::size_t> dist{0, std::size(names) + 3};
+   std::vector<std::string> to_ret(lookup_count);
+   for (auto& lookup : to_ret) {
+      const auto index = dist(rng);
+      lookup = index < std::size(names) ? names[index] : "unknown" + std::to_string(index);
+   }
+   return to_ret;
+}
+
+std::size_t if_chain(std::string_view command)
+{
+   for (std::size_t i = 0; i < std::size(names); ++i) {
+      if (command == names[i]) {
+         return i;
+      }
+   }
+   return std::size(names);
+}
+
+template<typename Dispatch>
+void run(const char* name, const std::vector<std::string>& lookups, Dispatch dispatch)
+{
+   std::size_t sum = 0;
+   const auto start = std::chrono::steady_clock::now();
+   for (int i = 0; i < repetitions; ++i) {
+      for (const auto& lookup : lookups) {
+         sum += dispatch(lookup);
+      }
+   }
+   const auto end = std::chrono::steady_clock::now();
+   const auto seconds = std::chrono::duration<double>(end - start).count();
+   std::printf("%s,%.2f,%zu\n", name, lookups.size() * repetitions / seconds / 1e6, sum / repetitions);
+}
+
+} // namespace
+
+int main()
+{
+   const auto lookups = make_lookups();
+   std::unordered_map<std::string_view, std::size_t> hash_map;
+   for (std::size_t i = 0; i < std::size(names); ++i) {
+      hash_map.emplace(names[i], i);
+   }
+   std::puts("dispatch,million_lookups_per_s,checksum");
+   run("khct::string_switch", lookups, [](std::string_view lookup) { return commands::index_of(lookup); });
+   run("if_chain", lookups, [](std::string_view lookup) { return if_chain(lookup); });
+   run("std::unordered_map", lookups, [&](std::string_view lookup) {
+      const auto found = hash_map.find(lookup);
+      return found == hash_map.end() ? std::size(names) : found->second;
+   });
+}
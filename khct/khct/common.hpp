@@ -1,10 +1,19 @@
 #ifndef KHCT_COMMON_HPP
 #define KHCT_COMMON_HPP
 
+#include <array>
 #include <compare>
 #include <concepts>
+#include <tuple>
+#include <type_traits>
 #include <utility>
 
+#if defined(__has_builtin)
+#if __has_builtin(__type_pack_element)
+#define KHCT_HAS_TYPE_PACK_ELEMENT
+#endif
+#endif
+
 namespace khct {
 
 struct nil_t {
@@ -34,17 +43,21 @@ concept weakly_equality_comparible_with = requires (const std::remove_reference_
 
 namespace detail {
 
-template<std::size_t I, auto First, auto... Rest>
-consteval auto get_at_index() noexcept
+// Little endian whatever the platform; compilers turn this into a single load where that's the native order
+template<typename T>
+constexpr T read_le(const char* bytes) noexcept
 {
-   if constexpr (I == 0) {
-      return First;
-   }
-   else {
-      return get_at_index<I - 1, Rest...>();
+   T to_ret = 0;
+   for (std::size_t i = 0; i < sizeof(T); ++i) {
+      to_ret |= static_cast<T>(static_cast<unsigned char>(bytes[i])) << (8 * i);
    }
+   return to_ret;
 }
 
+// Not constexpr, so reaching a call during constant evaluation is a compile error whose context shows the reason;
+// for checks on consteval function arguments, which a static_assert can't see and an assert loses under NDEBUG
+inline void compile_time_error(const char*) noexcept {}
+
 template<typename T>
 struct type_holder {
    using type = T;
@@ -52,55 +65,86 @@ struct type_holder {
 
 template<typename T, std::size_t I>
 struct tuple_base {
-   // TODO: Move only types?
    // This is needed for some reason???
-   constexpr tuple_base(const T& val) : value{val} {}
+   template<typename U>
+      requires(!std::same_as<std::remove_cvref_t<U>, tuple_base> && std::constructible_from<T, U &&>)
+   constexpr tuple_base(U&& val) noexcept(std::is_nothrow_constructible_v<T, U&&>) : value(std::forward<U>(val))
+   {}
 
    [[no_unique_address]] T value;
    friend constexpr bool operator==(const tuple_base&, const tuple_base&) noexcept = default;
    friend constexpr auto operator<=>(const tuple_base&, const tuple_base&) noexcept = default;
 };
 
-template<pair... TypesAndIndexes>
-struct tuple_impl : tuple_base<typename decltype(TypesAndIndexes.first)::type, TypesAndIndexes.second>... {
+// Only used to deduce T from an index; never defined. Lets element lookup fall to overload resolution against the
+// bases of a tuple_impl rather than recursing through the pack, so instantiation depth doesn't grow with arity
+template<std::size_t I, typename T>
+type_holder<T> element_type_holder(const tuple_base<T, I>*) noexcept;
+
+template<typename IndexSequence, typename... Ts>
+struct tuple_impl;
+
+template<std::size_t... Is, typename... Ts>
+struct tuple_impl<std::index_sequence<Is...>, Ts...> : tuple_base<Ts, Is>... {
+#ifdef KHCT_HAS_TYPE_PACK_ELEMENT
+   template<std::size_t I>
+   using element_type = __type_pack_element<I, Ts...>;
+#else
+   template<std::size_t I>
+   using element_type = decltype(element_type_holder<I>(static_cast<tuple_impl*>(nullptr)))::type;
+#endif
+
    template<std::size_t I>
    constexpr const auto& get() const& noexcept
    {
-      constexpr auto use_pair = get_at_index<I, TypesAndIndexes...>();
-      return static_cast<const tuple_base<typename decltype(use_pair.first)::type, use_pair.second>*>(this)->value;
+      return static_cast<const tuple_base<element_type<I>, I>*>(this)->value;
    }
 
    template<std::size_t I>
    constexpr auto& get() & noexcept
    {
-      constexpr auto use_pair = get_at_index<I, TypesAndIndexes...>();
-      return static_cast<tuple_base<typename decltype(use_pair.first)::type, use_pair.second>*>(this)->value;
+      return static_cast<tuple_base<element_type<I>, I>*>(this)->value;
+   }
+
+   template<std::size_t I>
+   constexpr auto&& get() && noexcept
+   {
+      return std::move(static_cast<tuple_base<element_type<I>, I>*>(this)->value);
    }
 
    template<std::size_t I>
-   constexpr auto get() && noexcept
+   constexpr auto&& get() const&& noexcept
    {
-      return get<I>();
+      return std::move(static_cast<const tuple_base<element_type<I>, I>*>(this)->value);
    }
 
    friend constexpr bool operator==(const tuple_impl&, const tuple_impl&) noexcept = default;
    friend constexpr auto operator<=>(const tuple_impl&, const tuple_impl&) noexcept = default;
 };
 
-template<typename... Ts, std::size_t... Is>
-consteval auto make_tuple(std::index_sequence<Is...>) noexcept
-{
-   return static_cast<tuple_impl<pair{type_holder<Ts>{}, Is}...>*>(nullptr);
-}
-
 } // namespace detail
 
 template<typename... Ts>
-struct tuple : std::remove_reference_t<decltype(*detail::make_tuple<Ts...>(std::index_sequence_for<Ts...>{}))> {
-   using base = std::remove_reference_t<decltype(*detail::make_tuple<Ts...>(std::index_sequence_for<Ts...>{}))>;
-
-   // TODO: Move only types?
-   constexpr tuple(const Ts&... values) noexcept : base{values...} {}
+struct tuple : detail::tuple_impl<std::index_sequence_for<Ts...>, Ts...> {
+   using base = detail::tuple_impl<std::index_sequence_for<Ts...>, Ts...>;
+
+   constexpr tuple(const Ts&... values) noexcept((std::is_nothrow_copy_constructible_v<Ts> && ...))
+      : base{values...}
+   {}
+
+   // Separate from the forwarding constructor so braced elements (e.g. tuple<move_only>{{10}}) are moved from
+   constexpr tuple(Ts&&... values) noexcept((std::is_nothrow_move_constructible_v<Ts> && ...))
+      requires(sizeof...(Ts) > 0)
+      : base{std::move(values)...}
+   {}
+
+   template<typename... Us>
+      requires(sizeof...(Us) == sizeof...(Ts) && sizeof...(Ts) > 0
+               && !(sizeof...(Ts) == 1 && (std::same_as<std::remove_cvref_t<Us>, tuple> && ...))
+               && (std::constructible_from<Ts, Us &&> && ...))
+   constexpr tuple(Us&&... values) noexcept((std::is_nothrow_constructible_v<Ts, Us &&> && ...))
+      : base{std::forward<Us>(values)...}
+   {}
 
    friend constexpr bool operator==(const tuple&, const tuple&) noexcept = default;
    friend constexpr auto operator<=>(const tuple&, const tuple&) noexcept = default;
@@ -119,20 +163,73 @@ constexpr bool operator==(const tuple<Ts1...>& lhs, const tuple<Ts2...>& rhs) no
    }(std::index_sequence_for<Ts1...>{});
 }
 
-template<typename... Ts1, typename... Ts2>
-constexpr tuple<Ts1..., Ts2...> tuple_cat(const tuple<Ts1...>& t1, const tuple<Ts2...>& t2) noexcept
+namespace detail {
+
+template<typename T>
+inline constexpr bool is_tuple = false;
+
+template<typename... Ts>
+inline constexpr bool is_tuple<tuple<Ts...>> = true;
+
+// For each element of the concatenated tuple, which argument it comes from and its index there
+template<std::size_t... Sizes>
+inline constexpr auto tuple_cat_indexes = [] {
+   std::array<pair<std::size_t, std::size_t>, (Sizes + ... + 0)> to_ret{};
+   std::size_t out = 0;
+   std::size_t outer = 0;
+   for (const auto size : {Sizes..., std::size_t{0}}) {
+      for (std::size_t inner = 0; inner < size; ++inner) {
+         to_ret[out++] = {outer, inner};
+      }
+      ++outer;
+   }
+   return to_ret;
+}();
+
+template<typename... Tuples, std::size_t... Is>
+consteval auto tuple_cat_type(std::index_sequence<Is...>) noexcept
+{
+   constexpr auto& indexes = tuple_cat_indexes<Tuples::size...>;
+   using all = std::tuple<Tuples...>;
+   return static_cast<
+      tuple<typename std::tuple_element_t<indexes[Is].first, all>::template element_type<indexes[Is].second>...>*>(
+      nullptr);
+}
+
+} // namespace detail
+
+/// @brief Concatenates any number of tuples, moving the elements of rvalue arguments
+template<typename... Tuples>
+   requires(detail::is_tuple<std::remove_cvref_t<Tuples>> && ...)
+constexpr auto tuple_cat(Tuples&&... tuples)
 {
-   return [&]<std::size_t... Is1, std::size_t... Is2>(std::index_sequence<Is1...>, std::index_sequence<Is2...>) {
-      return tuple<Ts1..., Ts2...>{t1.template get<Is1>()..., t2.template get<Is2>()...};
-   }(std::index_sequence_for<Ts1...>{}, std::index_sequence_for<Ts2...>{});
+   constexpr auto& indexes = detail::tuple_cat_indexes<std::remove_cvref_t<Tuples>::size...>;
+   using result = std::remove_pointer_t<decltype(detail::tuple_cat_type<std::remove_cvref_t<Tuples>...>(
+      std::make_index_sequence<indexes.size()>{}))>;
+   auto refs = std::forward_as_tuple(std::forward<Tuples>(tuples)...);
+   return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+      return result{std::get<indexes[Is].first>(std::move(refs)).template get<indexes[Is].second>()...};
+   }(std::make_index_sequence<indexes.size()>{});
+}
+
+template<std::size_t I, typename... Ts>
+constexpr auto& get(tuple<Ts...>& t) noexcept
+{
+   return t.template get<I>();
 }
 
 template<std::size_t I, typename... Ts>
-constexpr auto get(const tuple<Ts...> t) noexcept
+constexpr const auto& get(const tuple<Ts...>& t) noexcept
 {
    return t.template get<I>();
 }
 
+template<std::size_t I, typename... Ts>
+constexpr auto&& get(tuple<Ts...>&& t) noexcept
+{
+   return std::move(t).template get<I>();
+}
+
 template<typename... Types>
 concept has_common_type = requires() { typename std::common_type<Types...>::type; };
 
@@ -0,0 +1,196 @@
+#ifndef KHCT_FORMAT_HPP
+#define KHCT_FORMAT_HPP
+
+#include <khct/string.hpp>
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <concepts>
+#include <cstdint>
+#include <iterator>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace khct {
+
+namespace detail {
+
+// Writes into a buffer, dropping everything once something doesn't fit
+struct buffer_writer {
+   constexpr void write(std::string_view str) noexcept
+   {
+      if (overflowed || str.size() > static_cast<std::size_t>(end - pos)) {
+         overflowed = true;
+         return;
+      }
+      pos = std::ranges::copy(str, pos).out;
+   }
+
+   constexpr void write(std::uint64_t num) noexcept
+   {
+      char digits[20];
+      auto first = std::end(digits);
+      do {
+         *--first = static_cast<char>('0' + num % 10);
+         num /= 10;
+      } while (num != 0);
+      write(std::string_view{first, std::end(digits)});
+   }
+
+   constexpr void write(std::int64_t num) noexcept
+   {
+      if (num < 0) {
+         write("-");
+      }
+      // Negate as unsigned so the magnitude of the lowest value doesn't overflow
+      write(num < 0 ? 0 - static_cast<std::uint64_t>(num) : static_cast<std::uint64_t>(num));
+   }
+
+   // Not usable during constant evaluation
+   void write(double num) noexcept
+   {
+      char digits[32];
+      // The shortest representation that reads back as the same double
+      const auto result = std::to_chars(std::begin(digits), std::end(digits), num);
+      write(std::string_view{digits, result.ptr});
+   }
+
+   char* pos;
+   char* end;
+   bool overflowed = false;
+};
+
+// Appends the literal text of fmt to text with escaped braces ({{ and }}) unescaped, ending a piece at every {}.
+// Returns false on a brace that's neither
+constexpr bool parse_format(std::string_view fmt, std::string& text, std::vector<std::size_t>& ends)
+{
+   for (std::size_t i = 0; i < fmt.size(); ++i) {
+      const auto next = i + 1 < fmt.size() ? fmt[i + 1] : '\0';
+      if (fmt[i] == '{' && next == '}') {
+         ends.push_back(text.size());
+         ++i;
+      }
+      else if ((fmt[i] == '{' || fmt[i] == '}') && next == fmt[i]) {
+         text += fmt[i];
+         ++i;
+      }
+      else if (fmt[i] == '{' || fmt[i] == '}') {
+         return false;
+      }
+      else {
+         text += fmt[i];
+      }
+   }
+   ends.push_back(text.size());
+   return true;
+}
+
+template<std::size_t TextSize, std::size_t PieceCount>
+struct format_pieces {
+   // Piece i is what comes before argument i and the last piece is what comes after the last argument
+   constexpr std::string_view operator[](std::size_t i) const noexcept
+   {
+      const auto begin = i == 0 ? 0 : ends[i - 1];
+      return {text.begin() + begin, ends[i] - begin};
+   }
+
+   string<TextSize + 1> text;
+   std::array<std::size_t, PieceCount> ends;
+   bool valid;
+};
+
+// The literal text of Fmt as one string, split into the pieces between arguments
+template<string Fmt>
+inline constexpr auto format_string_pieces = []() {
+   constexpr auto fmt = std::string_view{Fmt.begin(), Fmt.size()};
+   constexpr auto sizes = [&]() {
+      std::string text;
+      std::vector<std::size_t> ends;
+      parse_format(fmt, text, ends);
+      return std::array{text.size(), ends.size()};
+   }();
+   std::string text;
+   std::vector<std::size_t> ends;
+   format_pieces<sizes[0], sizes[1]> to_ret{};
+   to_ret.valid = parse_format(fmt, text, ends);
+   std::ranges::copy(text, to_ret.text.begin());
+   std::ranges::copy(ends, to_ret.ends.begin());
+   return to_ret;
+}();
+
+template<typename T>
+concept formattable = std::integral<T> || std::floating_point<T> || string_like<T>
+                   || std::convertible_to<const T&, std::string_view>;
+
+template<formattable T>
+constexpr void write_formatted(buffer_writer& writer, const T& value) noexcept
+{
+   if constexpr (std::same_as<T, bool>) {
+      writer.write(value ? "true" : "false");
+   }
+   else if constexpr (std::same_as<T, char>) {
+      writer.write(std::string_view{&value, 1});
+   }
+   else if constexpr (std::signed_integral<T>) {
+      writer.write(static_cast<std::int64_t>(value));
+   }
+   else if constexpr (std::unsigned_integral<T>) {
+      writer.write(static_cast<std::uint64_t>(value));
+   }
+   else if constexpr (std::floating_point<T>) {
+      writer.write(static_cast<double>(value));
+   }
+   else if constexpr (string_like<T>) {
+      // string's conversion to std::string_view is consteval, so this works on runtime values too
+      writer.write(std::string_view{value.begin(), value.size()});
+   }
+   else {
+      writer.write(std::string_view{value});
+   }
+}
+
+} // namespace detail
+
+/// @brief Formats arguments into a buffer following a format string that's parsed at compile time
+///
+/// Each {} in Fmt is replaced with the next argument and {{ and }} stand for literal braces. Integers, bools, chars,
+/// floating point numbers (runtime only) and anything with a std::string_view conversion can be formatted. Any other
+/// brace, the wrong number of arguments and arguments of other types don't compile.
+template<string Fmt>
+struct formatter {
+   static_assert(detail::format_string_pieces<Fmt>.valid,
+                 "Braces in format strings have to be {} for an argument or escaped as {{ or }}");
+
+   inline static constexpr std::size_t argument_count = detail::format_string_pieces<Fmt>.ends.size() - 1;
+
+   /// @brief Writes the formatted text into buffer, returning the number of characters written or std::nullopt if it
+   /// doesn't fit
+   template<detail::formattable... Args>
+      requires(sizeof...(Args) == argument_count)
+   constexpr std::optional<std::size_t> operator()(std::span<char> buffer, const Args&... args) const noexcept
+   {
+      constexpr auto& pieces = detail::format_string_pieces<Fmt>;
+      detail::buffer_writer writer{buffer.data(), buffer.data() + buffer.size()};
+      writer.write(pieces[0]);
+      [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+         ((detail::write_formatted(writer, args), writer.write(pieces[Is + 1])), ...);
+      }(std::index_sequence_for<Args...>{});
+      if (writer.overflowed) {
+         return std::nullopt;
+      }
+      return static_cast<std::size_t>(writer.pos - buffer.data());
+   }
+};
+
+template<string Fmt>
+inline constexpr auto format = formatter<Fmt>{};
+
+} // namespace khct
+
+#endif // KHCT_FORMAT_HPP
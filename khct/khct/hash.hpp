@@ -0,0 +1,152 @@
+#ifndef KHCT_HASH_HPP
+#define KHCT_HASH_HPP
+
+#include <khct/common.hpp>
+#include <khct/map.hpp>
+#include <khct/string.hpp>
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+namespace khct {
+
+namespace detail {
+
+inline constexpr std::uint64_t xxh_prime1 = 0x9e3779b185ebca87;
+inline constexpr std::uint64_t xxh_prime2 = 0xc2b2ae3d27d4eb4f;
+inline constexpr std::uint64_t xxh_prime3 = 0x165667b19e3779f9;
+inline constexpr std::uint64_t xxh_prime4 = 0x85ebca77c2b2ae63;
+inline constexpr std::uint64_t xxh_prime5 = 0x27d4eb2f165667c5;
+
+constexpr std::uint64_t xxh_round(std::uint64_t acc, std::uint64_t input) noexcept
+{
+   return std::rotl(acc + input * xxh_prime2, 31) * xxh_prime1;
+}
+
+constexpr std::uint64_t xxh_merge_round(std::uint64_t acc, std::uint64_t value) noexcept
+{
+   return (acc ^ xxh_round(0, value)) * xxh_prime1 + xxh_prime4;
+}
+
+} // namespace detail
+
+/// @brief 64-bit FNV-1a
+constexpr std::uint64_t fnv1a(std::string_view str) noexcept
+{
+   std::uint64_t to_ret = 0xcbf29ce484222325;
+   for (const auto c : str) {
+      to_ret = (to_ret ^ static_cast<unsigned char>(c)) * 0x100000001b3;
+   }
+   return to_ret;
+}
+
+template<detail::string_like String>
+constexpr std::uint64_t fnv1a(const String& str) noexcept
+{
+   return fnv1a(std::string_view{str.begin(), str.size()});
+}
+
+/// @brief XXH64, which reads 8 bytes at a time and gives the same values as the reference implementation
+constexpr std::uint64_t xxhash64(std::string_view str, std::uint64_t seed = 0) noexcept
+{
+   auto pos = str.data();
+   const auto end = pos + str.size();
+   std::uint64_t to_ret;
+   if (str.size() >= 32) {
+      std::uint64_t acc[4]{
+         seed + detail::xxh_prime1 + detail::xxh_prime2, seed + detail::xxh_prime2, seed, seed - detail::xxh_prime1};
+      for (; end - pos >= 32; pos += 32) {
+         for (std::size_t i = 0; i < 4; ++i) {
+            acc[i] = detail::xxh_round(acc[i], detail::read_le<std::uint64_t>(pos + 8 * i));
+         }
+      }
+      to_ret = std::rotl(acc[0], 1) + std::rotl(acc[1], 7) + std::rotl(acc[2], 12) + std::rotl(acc[3], 18);
+      for (const auto lane : acc) {
+         to_ret = detail::xxh_merge_round(to_ret, lane);
+      }
+   }
+   else {
+      to_ret = seed + detail::xxh_prime5;
+   }
+   to_ret += str.size();
+   for (; end - pos >= 8; pos += 8) {
+      to_ret ^= detail::xxh_round(0, detail::read_le<std::uint64_t>(pos));
+      to_ret = std::rotl(to_ret, 27) * detail::xxh_prime1 + detail::xxh_prime4;
+   }
+   if (end - pos >= 4) {
+      to_ret ^= detail::read_le<std::uint32_t>(pos) * detail::xxh_prime1;
+      to_ret = std::rotl(to_ret, 23) * detail::xxh_prime2 + detail::xxh_prime3;
+      pos += 4;
+   }
+   for (; pos != end; ++pos) {
+      to_ret ^= static_cast<unsigned char>(*pos) * detail::xxh_prime5;
+      to_ret = std::rotl(to_ret, 11) * detail::xxh_prime1;
+   }
+   to_ret = (to_ret ^ (to_ret >> 33)) * detail::xxh_prime2;
+   to_ret = (to_ret ^ (to_ret >> 29)) * detail::xxh_prime3;
+   return to_ret ^ (to_ret >> 32);
+}
+
+template<detail::string_like String>
+constexpr std::uint64_t xxhash64(const String& str, std::uint64_t seed = 0) noexcept
+{
+   return xxhash64(std::string_view{str.begin(), str.size()}, seed);
+}
+
+/// @brief Seeded string hash for perfect_map using xxhash64
+struct xxhash64_hash {
+   constexpr std::uint64_t operator()(std::string_view str, std::uint64_t seed) const noexcept
+   {
+      return xxhash64(str, seed);
+   }
+};
+
+namespace detail {
+
+template<string... Cases>
+consteval auto make_string_switch_table() noexcept
+{
+   // Views into the template parameter objects, which live as long as the program
+   return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+      return perfect_map<std::string_view, std::size_t, sizeof...(Cases), xxhash64_hash>{
+         {{std::string_view{Cases.begin(), Cases.size()}, Is}...}};
+   }(std::index_sequence_for<decltype(Cases)...>{});
+}
+
+} // namespace detail
+
+/// @brief Finds which of the strings Cases a runtime string is, for use in a switch statement
+///
+/// The cases are placed in a perfect hash table at compile time (duplicate cases don't compile), so finding a string
+/// is one hash, one probe and a single comparison with the only case it could be.
+///
+///   using commands = string_switch<"start", "stop">;
+///   switch (commands::index_of(command)) {
+///   case commands::case_index<"start">: ...
+///   case commands::no_match: ...
+///   }
+template<string... Cases>
+   requires(sizeof...(Cases) > 0)
+struct string_switch {
+   inline static constexpr std::size_t no_match = sizeof...(Cases);
+
+   /// @brief The index of the case equal to str, or no_match if there isn't one
+   static constexpr std::size_t index_of(std::string_view str) noexcept { return table_[str].value_or(no_match); }
+
+   template<string Case>
+   inline static constexpr std::size_t case_index = []() {
+      constexpr auto to_ret = string_switch::index_of(std::string_view{Case.begin(), Case.size()});
+      static_assert(to_ret != no_match, "Not one of the cases");
+      return to_ret;
+   }();
+
+private:
+   inline static constexpr auto table_ = detail::make_string_switch_table<Cases...>();
+};
+
+} // namespace khct
+
+#endif // KHCT_HASH_HPP
@@ -2,16 +2,24 @@
 #define KHCT_JSON_HPP
 
 #include <khct/common.hpp>
+#include <khct/decimal.hpp>
 #include <khct/map.hpp>
 #include <khct/string.hpp>
 
 #include <algorithm>
-#include <cassert>
+#include <array>
+#include <bit>
 #include <compare>
 #include <cstdint>
 #include <limits>
 #include <optional>
+#include <ranges>
+#include <span>
+#include <string>
 #include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace khct {
 
@@ -80,303 +88,1792 @@ inline constexpr auto true_ = true_struct{};
 inline constexpr auto false_ = false_struct{};
 inline constexpr auto null = null_struct{};
 
+// The runtime counterparts of the json_error values
+enum class json_status : std::uint8_t {
+   ok,
+   number_too_large,
+   remaining_input,
+   unexpected_input,
+   invalid_double,
+   invalid_string,
+   unexpected_end_of_input,
+   // Only from json_document, when the document doesn't fit in its capacity
+   capacity_exceeded,
+};
+
+// The kinds of value in a document; integers are unsigned unless they're negative
+enum class json_kind : std::uint8_t {
+   object,
+   array,
+   string,
+   unsigned_integer,
+   signed_integer,
+   floating,
+   true_,
+   false_,
+   null,
+};
+
 namespace detail {
 
 inline constexpr auto is_num = [](char c) { return c >= '0' && c <= '9'; };
-inline constexpr auto is_nonzero_num = [](char c) { return c >= '1' && c <= '9'; };
+inline constexpr auto is_ws
+   = [](char c) { return c == ' ' || c == '\f' || c == '\n' || c == '\r' || c == '\t' || c == '\v'; };
 inline constexpr auto lex_comp = [](auto a, auto b) { return std::ranges::lexicographical_compare(a, b); };
 
-// Pre: Leading whitespace is stripped
-template<string Str>
-consteval std::optional<std::uint64_t> to_unsigned_num(std::uint64_t max_value) noexcept
+// An object member name padded to the length of the longest name in its object. It keeps its own length, as any
+// padding character could also end a real name, which would make "a" and "a " the same key
+template<std::size_t Size>
+struct json_name {
+   template<std::size_t NameSize>
+      requires(NameSize <= Size)
+   consteval json_name(const string<NameSize>& name) noexcept : value{name}, length{name.size()} {}
+
+   template<std::size_t NameSize>
+      requires(NameSize <= Size)
+   consteval json_name(const char (&name)[NameSize]) noexcept : json_name{string<NameSize>{name}} {}
+
+   constexpr auto begin() const noexcept { return value.begin(); }
+   constexpr auto end() const noexcept { return value.begin() + length; }
+   constexpr auto size() const noexcept { return length; }
+
+   string<Size> value;
+   std::size_t length;
+   friend auto operator<=>(const json_name&, const json_name&) = default;
+};
+
+template<typename T>
+inline constexpr bool is_json_name = false;
+
+template<std::size_t Size>
+inline constexpr bool is_json_name<json_name<Size>> = true;
+
+template<std::size_t Size>
+struct runtime_key<json_name<Size>> {
+   using type = std::string_view;
+   static constexpr std::string_view from(std::string_view key) noexcept { return key; }
+   static constexpr std::string_view from(const json_name<Size>& key) noexcept { return {key.begin(), key.size()}; }
+};
+
+// Returns std::nullopt if the value is larger than max_value
+// Pre: digits is non-empty and only contains digits
+constexpr std::optional<std::uint64_t> to_unsigned_num(std::string_view digits, std::uint64_t max_value) noexcept
 {
-   if (!is_num(Str[0])) {
-      return std::nullopt;
-   }
    std::uint64_t to_ret = 0;
-   for (auto iter = std::begin(Str); iter != std::end(Str) && is_num(*iter); ++iter) {
-      const auto next_value = to_ret * 10 + *iter - '0';
-      if (next_value > max_value || next_value < to_ret) {
+   for (const auto c : digits) {
+      if (to_ret > (max_value - (c - '0')) / 10) {
          return std::nullopt;
       }
-      to_ret = next_value;
+      to_ret = to_ret * 10 + (c - '0');
    }
    return to_ret;
 }
 
-template<string Str>
-consteval std::optional<std::int64_t> to_signed_num() noexcept
+// Pre: num is a valid integer that may start with a minus
+constexpr std::optional<std::int64_t> to_signed_num(std::string_view num) noexcept
 {
-   constexpr auto has_minus = Str[0] == '-';
-   constexpr auto no_minus = Str | splice<has_minus, Str.size()>;
-   constexpr auto val = to_unsigned_num<no_minus>(std::numeric_limits<std::int64_t>::lowest());
-   if constexpr (val) {
-      constexpr auto ret_val = static_cast<std::int64_t>(*val);
-      return has_minus ? -ret_val : ret_val;
-   }
-   else {
+   const auto has_minus = num[0] == '-';
+   const auto max_magnitude = static_cast<std::uint64_t>(std::numeric_limits<std::int64_t>::max()) + has_minus;
+   const auto magnitude = to_unsigned_num(num.substr(has_minus), max_magnitude);
+   if (!magnitude) {
       return std::nullopt;
    }
+   // Negate as unsigned so the magnitude of the lowest value doesn't overflow
+   return static_cast<std::int64_t>(has_minus ? 0 - *magnitude : *magnitude);
 }
 
-template<string Str>
-consteval std::optional<double> to_double() noexcept
+// One value (or object member name) of a document. Object members are stored as the name's string token followed by
+// the value's tokens, so an object with N members has 2N children.
+struct json_token {
+   json_kind kind;
+   // The characters of the token; for strings this excludes the quotes and for objects and arrays it includes
+   // the brackets
+   std::size_t offset;
+   std::size_t length;
+   // The number of elements of an array or members of an object
+   std::size_t child_count;
+   // Index of the token that follows this one and all of its children
+   std::size_t next;
+};
+
+// Checks that num follows the JSON number grammar and finds which type it'll be parsed into
+constexpr pair<json_status, json_kind> check_json_number(std::string_view num) noexcept
 {
-   constexpr auto e_loc = std::ranges::find_if(Str, [](char c) { return c == 'e' || c == 'E'; });
-   if constexpr (Str[0] == '-') {
-      constexpr auto val = to_double<Str | splice<1, Str.size()>>();
-      if constexpr (val) {
-         return -*val;
+   const auto skip_digits = [&](std::size_t i) {
+      while (i != num.size() && is_num(num[i])) {
+         ++i;
       }
-      else {
-         return std::nullopt;
+      return i;
+   };
+   const auto is_floating = num.find_first_of(".eE") != std::string_view::npos;
+   const auto invalid = is_floating ? json_status::invalid_double : json_status::unexpected_input;
+   std::size_t i = num[0] == '-';
+   if (i == num.size() || !is_num(num[i]) || (num[i] == '0' && i + 1 != num.size() && is_num(num[i + 1]))) {
+      return {invalid, json_kind::floating};
+   }
+   i = skip_digits(i);
+   if (i != num.size() && num[i] == '.') {
+      const auto fraction_end = skip_digits(i + 1);
+      if (fraction_end == i + 1) {
+         return {invalid, json_kind::floating};
       }
+      i = fraction_end;
    }
-   else if constexpr (e_loc == std::end(Str)) {
-      double to_ret = 0;
-      auto iter = std::begin(Str);
-      for (; iter != std::end(Str) && is_num(*iter); ++iter) {
-         to_ret = to_ret * 10 + *iter - '0';
+   if (i != num.size() && (num[i] == 'e' || num[i] == 'E')) {
+      i += 1 + (i + 1 != num.size() && (num[i + 1] == '-' || num[i + 1] == '+'));
+      const auto exponent_end = skip_digits(i);
+      if (exponent_end == i) {
+         return {invalid, json_kind::floating};
       }
-      assert(*iter == '.');
-      ++iter;
-      double mult = 0.1;
-      for (; iter != std::end(Str) && is_num(*iter); ++iter) {
-         to_ret += mult * (*iter - '0');
-         mult /= 10;
+      i = exponent_end;
+   }
+   if (i != num.size()) {
+      return {invalid, json_kind::floating};
+   }
+   if (is_floating) {
+      return {json_status::ok, json_kind::floating};
+   }
+   if (num[0] == '-') {
+      return {to_signed_num(num) ? json_status::ok : json_status::number_too_large, json_kind::signed_integer};
+   }
+   return {
+      to_unsigned_num(num, std::numeric_limits<std::uint64_t>::max()) ? json_status::ok : json_status::number_too_large,
+      json_kind::unsigned_integer};
+}
+
+// Returns the index of the quote that ends the string whose opening quote is at i, or std::string_view::npos if it
+// isn't terminated
+constexpr std::size_t find_json_string_end(std::string_view str, std::size_t i) noexcept
+{
+   for (++i; i != str.size(); ++i) {
+      if (str[i] == '"') {
+         return i;
       }
-      return to_ret;
+      // Skip whatever is escaped; escapes are kept as is in the parsed string
+      i += str[i] == '\\' && i + 1 != str.size();
    }
-   else {
-      constexpr auto e_index = std::distance(std::begin(Str), e_loc);
-      constexpr auto left_side = to_signed_num<Str | splice<0, e_index>>();
-      constexpr auto right_side_str = Str | splice<e_index + 1, Str.size()>;
-      constexpr auto starts_plus = right_side_str[0] == '+';
-      constexpr auto right_side = to_signed_num<right_side_str | splice<starts_plus, right_side_str.size()>>();
-      if constexpr (!left_side || !right_side) {
-         return std::nullopt;
+   return std::string_view::npos;
+}
+
+// The length of the number str starts with, to be checked with check_json_number
+constexpr std::size_t json_number_length(std::string_view str) noexcept
+{
+   std::size_t i = 0;
+   while (i != str.size()
+          && (is_num(str[i]) || str[i] == '-' || str[i] == '+' || str[i] == '.' || str[i] == 'e' || str[i] == 'E')) {
+      ++i;
+   }
+   return i;
+}
+
+// Scans the whole document once, appending its tokens in document order; on an error the tokens read so far are
+// kept. Open objects and arrays are kept on a stack so nesting depth isn't limited by recursion.
+constexpr json_status tokenize_json(std::string_view str, std::vector<json_token>& tokens)
+{
+   std::vector<std::size_t> open;
+   const auto skip_ws = [&](std::size_t i) {
+      while (i != str.size() && is_ws(str[i])) {
+         ++i;
+      }
+      return i;
+   };
+   const auto closing_char = [&](std::size_t index) {
+      return tokens[index].kind == json_kind::object ? '}' : ']';
+   };
+   const auto close = [&](std::size_t pos) {
+      auto& token = tokens[open.back()];
+      token.length = pos + 1 - token.offset;
+      token.next = tokens.size();
+      open.pop_back();
+   };
+
+   std::size_t pos = skip_ws(0);
+   while (true) {
+      // Expecting a value, or the end of an empty object or array
+      auto closed_empty = false;
+      if (!open.empty()) {
+         const auto parent = open.back();
+         if (tokens[parent].child_count == 0 && pos != str.size() && str[pos] == closing_char(parent)) {
+            close(pos);
+            ++pos;
+            closed_empty = true;
+         }
+         else {
+            ++tokens[parent].child_count;
+            if (tokens[parent].kind == json_kind::object) {
+               if (pos == str.size()) {
+                  return json_status::unexpected_end_of_input;
+               }
+               const auto name_end = str[pos] == '"' ? find_json_string_end(str, pos) : std::string_view::npos;
+               if (name_end == std::string_view::npos) {
+                  return json_status::invalid_string;
+               }
+               tokens.push_back({json_kind::string, pos + 1, name_end - pos - 1, 0, tokens.size() + 1});
+               pos = skip_ws(name_end + 1);
+               if (pos == str.size()) {
+                  return json_status::unexpected_end_of_input;
+               }
+               if (str[pos] != ':') {
+                  return json_status::unexpected_input;
+               }
+               pos = skip_ws(pos + 1);
+            }
+         }
       }
-      else if constexpr (*right_side >= 0) {
-         double mult = 1;
-         for (double i = 0; i < *right_side; i += 1) {
-            mult *= 10;
+      if (!closed_empty) {
+         if (pos == str.size()) {
+            return json_status::unexpected_end_of_input;
+         }
+         const auto rest = str.substr(pos);
+         const auto index = tokens.size();
+         if (rest[0] == '{' || rest[0] == '[') {
+            const auto kind = rest[0] == '{' ? json_kind::object : json_kind::array;
+            tokens.push_back({kind, pos, 0, 0, 0});
+            open.push_back(index);
+            pos = skip_ws(pos + 1);
+            continue;
+         }
+         else if (rest[0] == '"') {
+            const auto end = find_json_string_end(str, pos);
+            if (end == std::string_view::npos) {
+               return json_status::invalid_string;
+            }
+            tokens.push_back({json_kind::string, pos + 1, end - pos - 1, 0, index + 1});
+            pos = end + 1;
+         }
+         else if (rest[0] == '-' || is_num(rest[0])) {
+            const auto length = json_number_length(rest);
+            const auto [status, kind] = check_json_number(rest.substr(0, length));
+            if (status != json_status::ok) {
+               return status;
+            }
+            tokens.push_back({kind, pos, length, 0, index + 1});
+            pos += length;
+         }
+         else if (rest.starts_with("true")) {
+            tokens.push_back({json_kind::true_, pos, 4, 0, index + 1});
+            pos += 4;
+         }
+         else if (rest.starts_with("false")) {
+            tokens.push_back({json_kind::false_, pos, 5, 0, index + 1});
+            pos += 5;
+         }
+         else if (rest.starts_with("null")) {
+            tokens.push_back({json_kind::null, pos, 4, 0, index + 1});
+            pos += 4;
+         }
+         else {
+            return json_status::unexpected_input;
          }
-         return *left_side * mult;
       }
-      else {
-         double mult = 1;
-         for (double i = 0; i < -*right_side; i += 1) {
-            mult *= .1;
+      // A value has ended; close every object or array that ends here and then expect a comma
+      while (true) {
+         pos = skip_ws(pos);
+         if (open.empty()) {
+            return pos == str.size() ? json_status::ok : json_status::remaining_input;
+         }
+         if (pos == str.size()) {
+            return json_status::unexpected_end_of_input;
          }
-         return *left_side * mult;
+         if (str[pos] == ',') {
+            pos = skip_ws(pos + 1);
+            break;
+         }
+         if (str[pos] != closing_char(open.back())) {
+            return json_status::unexpected_input;
+         }
+         close(pos);
+         ++pos;
       }
    }
 }
 
+template<std::size_t Size>
+struct json_token_array {
+   std::array<json_token, Size> tokens;
+   json_status status;
+};
+
+template<string Str>
+consteval auto make_json_tokens()
+{
+   constexpr auto str = std::string_view{Str.begin(), Str.size()};
+   constexpr auto size = [&]() {
+      std::vector<json_token> tokens;
+      tokenize_json(str, tokens);
+      return tokens.size();
+   }();
+   std::vector<json_token> tokens;
+   json_token_array<size> to_ret{{}, tokenize_json(str, tokens)};
+   std::ranges::copy(tokens, to_ret.tokens.begin());
+   return to_ret;
+}
+
 template<string Str>
-consteval auto parse_json_value() noexcept;
+inline constexpr auto json_tokens = make_json_tokens<Str>();
+
+// The indexes of the tokens directly inside the object or array at Index
+template<string Str, std::size_t Index>
+inline constexpr auto json_children = []() {
+   constexpr auto& tokens = json_tokens<Str>.tokens;
+   constexpr auto is_object = tokens[Index].kind == json_kind::object;
+   std::array<std::size_t, tokens[Index].child_count * (is_object ? 2 : 1)> to_ret;
+   std::size_t child = Index + 1;
+   for (auto& index : to_ret) {
+      index = child;
+      child = tokens[child].next;
+   }
+   return to_ret;
+}();
 
-template<string ToParse>
-consteval auto parse_array_value() noexcept
+template<json_status Status>
+consteval auto to_json_error() noexcept
 {
-   constexpr auto first_value_and_rest = parse_json_value<ToParse>();
-   // First value has been parsed; check for a comma and quit parsing if there isn't one
-   constexpr auto first_value = first_value_and_rest.first;
-   constexpr auto rest = strip_leading_whitespace<first_value_and_rest.second>();
-   if constexpr (rest[0] == ']') {
-      return pair{tuple{first_value}, rest | splice<1, rest.size()>};
+   if constexpr (Status == json_status::number_too_large) {
+      return json_error::number_too_large;
+   }
+   else if constexpr (Status == json_status::remaining_input) {
+      return json_error::remaining_input;
+   }
+   else if constexpr (Status == json_status::unexpected_input) {
+      return json_error::unexpected_input;
+   }
+   else if constexpr (Status == json_status::invalid_double) {
+      return json_error::invalid_double;
    }
-   else if constexpr (rest[0] == ',') {
-      constexpr auto parse_next = strip_leading_whitespace<rest | splice<1, rest.size()>>();
-      constexpr auto value_and_rest = parse_array_value<parse_next>();
-      if constexpr (is_json_error(value_and_rest.first)) {
-         return value_and_rest;
+   else if constexpr (Status == json_status::invalid_string) {
+      return json_error::invalid_string;
+   }
+   else {
+      static_assert(Status == json_status::unexpected_end_of_input);
+      return json_error::unexpected_end_of_input;
+   }
+}
+
+// Pre: The document tokenized successfully
+template<string Str, std::size_t Index>
+consteval auto make_json_value() noexcept
+{
+   constexpr auto token = json_tokens<Str>.tokens[Index];
+   constexpr auto text = std::string_view{Str.begin() + token.offset, token.length};
+   if constexpr (token.kind == json_kind::object) {
+      if constexpr (token.child_count == 0) {
+         // Create an empty multi_type_map in this case
+         return multi_type_map<string<1>, decltype(lex_comp), 0, {}, {}>{};
       }
       else {
-         return pair{tuple_cat(tuple{first_value}, value_and_rest.first), value_and_rest.second};
+         constexpr auto& children = json_children<Str, Index>;
+         // Every name is made as long as the longest so they share a key type
+         constexpr auto name_size = []() {
+            std::size_t to_ret = 0;
+            for (std::size_t i = 0; i < children.size(); i += 2) {
+               to_ret = std::max(to_ret, json_tokens<Str>.tokens[children[i]].length);
+            }
+            return to_ret + 1;
+         }();
+         return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+            return make_multi_type_map<pair{
+               json_name<name_size>{make_json_value<Str, children[2 * Is]>()},
+               make_json_value<Str, children[2 * Is + 1]>()}...>(lex_comp);
+         }(std::make_index_sequence<token.child_count>{});
       }
    }
+   else if constexpr (token.kind == json_kind::array) {
+      constexpr auto& children = json_children<Str, Index>;
+      return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+         return tuple{make_json_value<Str, children[Is]>()...};
+      }(std::make_index_sequence<token.child_count>{});
+   }
+   else if constexpr (token.kind == json_kind::string) {
+      return Str.template splice<token.offset, token.offset + token.length>();
+   }
+   else if constexpr (token.kind == json_kind::unsigned_integer) {
+      return *to_unsigned_num(text, std::numeric_limits<std::uint64_t>::max());
+   }
+   else if constexpr (token.kind == json_kind::signed_integer) {
+      return *to_signed_num(text);
+   }
+   else if constexpr (token.kind == json_kind::floating) {
+      return to_double(text);
+   }
+   else if constexpr (token.kind == json_kind::true_) {
+      return true_;
+   }
+   else if constexpr (token.kind == json_kind::false_) {
+      return false_;
+   }
    else {
-      return pair{json_error::unexpected_input, string{""}};
+      return null;
    }
 }
 
+} // namespace detail
+
 template<string Str>
-consteval auto parse_json_string() noexcept
+consteval auto parse_json() noexcept
 {
-   if constexpr (Str[0] != '"') {
-      return pair{json_error::invalid_string, string{""}};
+   constexpr auto status = detail::json_tokens<Str>.status;
+   if constexpr (status == json_status::ok) {
+      return detail::make_json_value<Str, 0>();
    }
    else {
-      constexpr auto str_end = []() {
-         auto loc = Str.begin();
-         while (true) {
-            ++loc;
-            while (loc != Str.end() && *loc != '\"') {
-               ++loc;
-            }
-            // The below doesn't work for some reason...?
-            // loc = std::find(loc + 1, Str.end(), '"');
-            if (loc == Str.end() || *(loc - 1) != '\\') {
-               return loc;
-            }
+      return detail::to_json_error<status>();
+   }
+}
+
+namespace detail {
+
+// The reference tokens of a JSON pointer with ~0 and ~1 decoded, stored end to end in chars
+template<std::size_t Count, std::size_t CharCount>
+struct json_pointer_tokens {
+   constexpr std::size_t size() const noexcept { return Count; }
+
+   constexpr std::string_view operator[](std::size_t index) const noexcept
+   {
+      return std::string_view{chars.data(), CharCount}.substr(ends[index] - lengths[index], lengths[index]);
+   }
+
+   std::array<std::size_t, Count> ends;
+   std::array<std::size_t, Count> lengths;
+   std::array<char, CharCount> chars;
+   bool valid;
+};
+
+// Pre: pointer is empty or starts with '/'
+constexpr bool decode_json_pointer(std::string_view pointer, std::string& chars, std::vector<std::size_t>& ends)
+{
+   for (std::size_t i = 0; i != pointer.size(); ++i) {
+      if (pointer[i] == '/') {
+         if (i != 0) {
+            ends.push_back(chars.size());
          }
-      }();
-      if constexpr (str_end == Str.end()) {
-         return pair{json_error::invalid_string, string{""}};
+      }
+      else if (pointer[i] != '~') {
+         chars += pointer[i];
+      }
+      else if (i + 1 != pointer.size() && (pointer[i + 1] == '0' || pointer[i + 1] == '1')) {
+         chars += pointer[i + 1] == '0' ? '~' : '/';
+         ++i;
       }
       else {
-         constexpr auto end_index = std::distance(Str.begin(), str_end);
-         return pair{Str | splice<1, end_index>, Str | splice<end_index + 1, Str.size()>};
+         return false;
       }
    }
+   if (!pointer.empty()) {
+      ends.push_back(chars.size());
+   }
+   return true;
 }
 
-template<string Str>
-consteval auto parse_object_value() noexcept
+template<string Pointer>
+inline constexpr auto json_pointer = []() {
+   constexpr auto pointer = std::string_view{Pointer.begin(), Pointer.size()};
+   constexpr auto starts_right = pointer.empty() || pointer[0] == '/';
+   constexpr auto sizes = [&]() {
+      std::string chars;
+      std::vector<std::size_t> ends;
+      if (starts_right) {
+         decode_json_pointer(pointer, chars, ends);
+      }
+      return pair{ends.size(), chars.size()};
+   }();
+   std::string chars;
+   std::vector<std::size_t> ends;
+   json_pointer_tokens<sizes.first, sizes.second> to_ret{{}, {}, {}, starts_right};
+   to_ret.valid = to_ret.valid && decode_json_pointer(pointer, chars, ends);
+   for (std::size_t i = 0; i != ends.size(); ++i) {
+      to_ret.ends[i] = ends[i];
+      to_ret.lengths[i] = ends[i] - (i == 0 ? 0 : ends[i - 1]);
+   }
+   std::ranges::copy(chars, to_ret.chars.begin());
+   return to_ret;
+}();
+
+// A reference token names an array element if it's a number without leading zeros; "-", the element after the last,
+// never exists in a parsed document
+constexpr std::optional<std::size_t> json_pointer_index(std::string_view token) noexcept
+{
+   if (token.empty() || (token[0] == '0' && token.size() != 1) || !std::ranges::all_of(token, is_num)) {
+      return std::nullopt;
+   }
+   return to_unsigned_num(token, std::numeric_limits<std::size_t>::max());
+}
+
+template<typename T>
+inline constexpr bool is_json_object = false;
+
+template<
+   typename Key,
+   typename Comp,
+   std::size_t Size,
+   std::array<Key, Size> Keys,
+   std::array<std::size_t, Size> Mapping,
+   auto... Values>
+inline constexpr bool is_json_object<multi_type_map<Key, Comp, Size, Keys, Mapping, Values...>> = true;
+
+// The index of the member named name in an object from parse_json, in the sorted order get_at uses
+template<typename Object>
+struct json_member_index;
+
+template<
+   typename Key,
+   typename Comp,
+   std::size_t Size,
+   std::array<Key, Size> Keys,
+   std::array<std::size_t, Size> Mapping,
+   auto... Values>
+struct json_member_index<multi_type_map<Key, Comp, Size, Keys, Mapping, Values...>> {
+   static constexpr std::optional<std::size_t> of(std::string_view name) noexcept
+   {
+      // Names keep their own length through runtime_key, so names ending in spaces match exactly
+      const auto loc = std::ranges::find(Keys, name, [](const Key& key) { return runtime_key<Key>::from(key); });
+      if (loc == Keys.end()) {
+         return std::nullopt;
+      }
+      return static_cast<std::size_t>(loc - Keys.begin());
+   }
+};
+
+template<string Pointer, std::size_t Step, typename Value>
+constexpr decltype(auto) json_at(const Value& value) noexcept
 {
-   constexpr auto name_and_rest = parse_json_string<Str>();
-   if constexpr (is_json_error(name_and_rest)) {
-      return name_and_rest;
+   constexpr auto& pointer = json_pointer<Pointer>;
+   if constexpr (Step == pointer.size()) {
+      return (value);
+   }
+   else if constexpr (is_tuple<Value>) {
+      constexpr auto index = json_pointer_index(pointer[Step]);
+      if constexpr (!index || *index >= Value::size) {
+         return nil;
+      }
+      else {
+         return json_at<Pointer, Step + 1>(value.template get<*index>());
+      }
+   }
+   else if constexpr (is_json_object<Value>) {
+      constexpr auto index = json_member_index<Value>::of(pointer[Step]);
+      if constexpr (!index) {
+         return nil;
+      }
+      else {
+         return json_at<Pointer, Step + 1>(Value::template get_at<*index>());
+      }
    }
    else {
-      constexpr auto colon_start = strip_leading_whitespace<name_and_rest.second>();
-      if constexpr (colon_start[0] != ':') {
-         return pair{json_error::unexpected_input, string{""}};
+      return nil;
+   }
+}
+
+// The index of the token Pointer refers to, found by skipping over every sibling before it, or std::nullopt if there
+// isn't one. Objects with several members of the same name give the first, as json_value does.
+// Pre: The document tokenized successfully
+template<string Str, string Pointer>
+consteval std::optional<std::size_t> json_pointer_token() noexcept
+{
+   constexpr auto str = std::string_view{Str.begin(), Str.size()};
+   constexpr auto& tokens = json_tokens<Str>.tokens;
+   constexpr auto& pointer = json_pointer<Pointer>;
+   std::size_t index = 0;
+   for (std::size_t step = 0; step != pointer.size(); ++step) {
+      const auto& token = tokens[index];
+      if (token.kind == json_kind::array) {
+         const auto element = json_pointer_index(pointer[step]);
+         if (!element || *element >= token.child_count) {
+            return std::nullopt;
+         }
+         ++index;
+         for (auto i = *element; i != 0; --i) {
+            index = tokens[index].next;
+         }
+      }
+      else if (token.kind == json_kind::object) {
+         auto name = index + 1;
+         while (name != token.next && str.substr(tokens[name].offset, tokens[name].length) != pointer[step]) {
+            name = tokens[name + 1].next;
+         }
+         if (name == token.next) {
+            return std::nullopt;
+         }
+         index = name + 1;
       }
       else {
-         constexpr auto value_start = strip_leading_whitespace<colon_start | splice<1, colon_start.size()>>();
-         constexpr auto value_and_next = parse_json_value<value_start>();
-         if constexpr (is_json_error(value_and_next)) {
-            return value_and_next;
+         return std::nullopt;
+      }
+   }
+   return index;
+}
+
+} // namespace detail
+
+/// @brief The value the JSON pointer (RFC 6901) Pointer refers to in what parse_json gave, or nil if there isn't one
+///
+/// The whole pointer is decoded once at compile time and each of its reference tokens becomes a get, so it costs the
+/// same at runtime as writing the gets out. Member names are compared as they're written in the document, with any
+/// escapes kept as is.
+///
+///   at<"/object/array/2">(parse_json<R"({"object": {"array": [true, false, 3]}})">()) == 3u
+template<string Pointer, typename Value>
+constexpr decltype(auto) at(const Value& value) noexcept
+{
+   static_assert(
+      detail::json_pointer<Pointer>.valid,
+      "Not a JSON pointer; it has to be empty or start with '/', and '~' can only be followed by 0 or 1");
+   return detail::json_at<Pointer, 0>(value);
+}
+
+/// @brief Parses only the value the JSON pointer Pointer refers to in the document Str
+///
+/// The document is still checked in full, but none of it outside of the value is turned into types, which makes
+/// reading a few values from a large document much cheaper to compile than parse_json followed by at. Gives nil if
+/// there is no such value and the json_error if the document is invalid.
+template<string Str, string Pointer>
+consteval auto parse_json_at() noexcept
+{
+   static_assert(
+      detail::json_pointer<Pointer>.valid,
+      "Not a JSON pointer; it has to be empty or start with '/', and '~' can only be followed by 0 or 1");
+   constexpr auto status = detail::json_tokens<Str>.status;
+   if constexpr (status != json_status::ok) {
+      return detail::to_json_error<status>();
+   }
+   else if constexpr (constexpr auto index = detail::json_pointer_token<Str, Pointer>(); !index) {
+      return nil;
+   }
+   else {
+      return detail::make_json_value<Str, *index>();
+   }
+}
+
+namespace detail {
+
+// Where a member of the outermost object or array is in the document; elements of arrays have no name
+struct json_member_span {
+   std::size_t name_offset;
+   std::size_t name_length;
+   std::size_t value_offset;
+   std::size_t value_length;
+};
+
+// Finds where the value starting at pos ends only by matching brackets and skipping over strings, so nothing inside
+// it is checked. Gives std::string_view::npos if the document ends first.
+constexpr std::size_t skip_json_value(std::string_view str, std::size_t pos) noexcept
+{
+   std::size_t depth = 0;
+   for (; pos != str.size(); ++pos) {
+      const auto c = str[pos];
+      if (c == '"') {
+         pos = find_json_string_end(str, pos);
+         if (pos == std::string_view::npos) {
+            return pos;
          }
-         else {
-            constexpr auto indicator_start = strip_leading_whitespace<value_and_next.second>();
-            constexpr auto ret_val = tuple{pair{name_and_rest.first, value_and_next.first}};
-            if constexpr (indicator_start.size() == 0) {
-               return pair{json_error::unexpected_end_of_input, string{""}};
-            }
-            else {
-               constexpr auto next_str
-                  = strip_leading_whitespace<indicator_start | splice<1, indicator_start.size()>>();
-               if constexpr (indicator_start[0] == '}') {
-                  return pair{ret_val, next_str};
-               }
-               else if constexpr (indicator_start[0] == ',') {
-                  constexpr auto next_val = parse_object_value<next_str>();
-                  return pair{tuple_cat(ret_val, next_val.first), next_val.second};
-               }
-               else {
-                  return pair{json_error::unexpected_input, string{""}};
-               }
-            }
+         if (depth == 0) {
+            return pos + 1;
+         }
+      }
+      else if (c == '{' || c == '[') {
+         ++depth;
+      }
+      else if (c == '}' || c == ']') {
+         // At depth 0 this closes whatever the value is in, so the value ended just before it
+         if (depth == 0) {
+            return pos;
+         }
+         if (--depth == 0) {
+            return pos + 1;
          }
       }
+      else if (depth == 0 && (c == ',' || is_ws(c))) {
+         return pos;
+      }
    }
+   return depth == 0 ? pos : std::string_view::npos;
 }
 
-// Pre: Leading whitespace is stripped
-template<string Str>
-consteval auto parse_json_value() noexcept
+// Finds the members of the outermost object or array, checking only the punctuation between them
+constexpr json_status index_json_members(std::string_view str, std::vector<json_member_span>& members, bool& is_object)
 {
-   if constexpr (Str[0] == '{') {
-      constexpr auto next = strip_leading_whitespace<Str | splice<1, Str.size()>>();
-      if constexpr (next[0] == '}') {
-         // Create an empty multi_type_map in this case
-         return pair{multi_type_map<string<1>, decltype(lex_comp), 0, {}, {}>{}, next | splice<1, next.size()>};
+   const auto skip_ws = [&](std::size_t i) {
+      while (i != str.size() && is_ws(str[i])) {
+         ++i;
       }
-      else {
-         constexpr auto tuple_val = parse_object_value<next>();
-         if constexpr (is_json_error(tuple_val.first)) {
-            return tuple_val;
+      return i;
+   };
+   auto pos = skip_ws(0);
+   if (pos == str.size()) {
+      return json_status::unexpected_end_of_input;
+   }
+   if (str[pos] != '{' && str[pos] != '[') {
+      return json_status::unexpected_input;
+   }
+   is_object = str[pos] == '{';
+   const auto closing_char = is_object ? '}' : ']';
+   pos = skip_ws(pos + 1);
+   if (pos != str.size() && str[pos] == closing_char) {
+      return skip_ws(pos + 1) == str.size() ? json_status::ok : json_status::remaining_input;
+   }
+   while (true) {
+      json_member_span member{0, 0, 0, 0};
+      if (is_object) {
+         if (pos == str.size()) {
+            return json_status::unexpected_end_of_input;
          }
-         else {
-            constexpr auto map = [&]<std::size_t... Is>(std::index_sequence<Is...>) {
-               return make_multi_type_map<get<Is>(tuple_val.first)...>(lex_comp);
-            }(std::make_index_sequence<tuple_val.first.size>{});
-            return pair{map, tuple_val.second};
+         const auto name_end = str[pos] == '"' ? find_json_string_end(str, pos) : std::string_view::npos;
+         if (name_end == std::string_view::npos) {
+            return json_status::invalid_string;
+         }
+         member.name_offset = pos + 1;
+         member.name_length = name_end - pos - 1;
+         pos = skip_ws(name_end + 1);
+         if (pos == str.size()) {
+            return json_status::unexpected_end_of_input;
+         }
+         if (str[pos] != ':') {
+            return json_status::unexpected_input;
          }
+         pos = skip_ws(pos + 1);
       }
+      const auto value_end = skip_json_value(str, pos);
+      if (value_end == std::string_view::npos) {
+         return json_status::unexpected_end_of_input;
+      }
+      if (value_end == pos) {
+         return pos == str.size() ? json_status::unexpected_end_of_input : json_status::unexpected_input;
+      }
+      member.value_offset = pos;
+      member.value_length = value_end - pos;
+      members.push_back(member);
+      pos = skip_ws(value_end);
+      if (pos == str.size()) {
+         return json_status::unexpected_end_of_input;
+      }
+      if (str[pos] == closing_char) {
+         return skip_ws(pos + 1) == str.size() ? json_status::ok : json_status::remaining_input;
+      }
+      if (str[pos] != ',') {
+         return json_status::unexpected_input;
+      }
+      pos = skip_ws(pos + 1);
    }
-   else if constexpr (Str[0] == '[') {
-      constexpr auto next = strip_leading_whitespace<Str | splice<1, Str.size()>>();
-      if constexpr (next[0] == ']') {
-         return pair{tuple{}, next | splice<1, next.size()>};
+}
+
+template<std::size_t Size>
+struct json_member_index_table {
+   std::array<json_member_span, Size> members;
+   json_status status;
+   bool is_object;
+};
+
+template<string Str>
+inline constexpr auto json_member_spans = []() {
+   constexpr auto str = std::string_view{Str.begin(), Str.size()};
+   constexpr auto size = [&]() {
+      std::vector<json_member_span> members;
+      auto is_object = false;
+      index_json_members(str, members, is_object);
+      return members.size();
+   }();
+   std::vector<json_member_span> members;
+   json_member_index_table<size> to_ret{{}, json_status::ok, false};
+   to_ret.status = index_json_members(str, members, to_ret.is_object);
+   std::ranges::copy(members, to_ret.members.begin());
+   return to_ret;
+}();
+
+} // namespace detail
+
+/// @brief A handle to the JSON object or array Str that only parses the members that are asked for
+///
+/// Only the outermost object or array is looked at up front, and only as far as matching brackets and quotes to find
+/// where each member is; a member's value is parsed with parse_json, and checked, when it's first asked for. A
+/// document that's mostly never read then costs little more to compile than its text does.
+template<string Str>
+struct lazy_json {
+   /// @brief The number of members of the object or elements of the array
+   static constexpr std::size_t size() noexcept { return table_.members.size(); }
+
+   /// @brief parse_json of the value of the first member named Name, or nil if there is no such member
+   template<string Name>
+   static consteval auto get() noexcept
+   {
+      if constexpr (table_.status != json_status::ok) {
+         return detail::to_json_error<table_.status>();
       }
       else {
-         return parse_array_value<next>();
-      }
-   }
-   else if constexpr (is_nonzero_num(Str[0]) || Str[0] == '-') {
-      // Look ahead for a period or e to determine if it's a float
-      constexpr auto end_number_loc = std::ranges::find_if_not(
-         Str, [](char c) { return c == '-' || c == '.' || c == 'e' || c == 'E' || c == '+' || is_num(c); });
-      constexpr auto num_str = Str | splice<0, std::distance(std::begin(Str), end_number_loc)>;
-      constexpr auto ret_str = Str | splice<std::distance(std::begin(Str), end_number_loc), Str.size()>;
-      constexpr auto has_period_or_e
-         = std::ranges::find_if(num_str, [](char c) { return c == '.' || c == 'e' || c == 'E'; }) != std::end(num_str);
-      if constexpr (has_period_or_e) {
-         constexpr auto val = to_double<Str>();
-         if constexpr (val) {
-            return pair{*val, ret_str};
+         constexpr auto index = find(std::string_view{Name.begin(), Name.size()});
+         if constexpr (index == size() || !table_.is_object) {
+            return nil;
          }
          else {
-            return pair{json_error::invalid_double, string{""}};
+            return parse_member<index>();
          }
       }
+   }
+
+   /// @brief parse_json of the element at index I of an array, or nil if there is no such element
+   template<std::size_t I>
+   static consteval auto get() noexcept
+   {
+      if constexpr (table_.status != json_status::ok) {
+         return detail::to_json_error<table_.status>();
+      }
+      else if constexpr (I >= size() || table_.is_object) {
+         return nil;
+      }
       else {
-         if constexpr (Str[0] == '-') {
-            constexpr auto val = to_signed_num<Str>();
-            if constexpr (val) {
-               return pair{*val, ret_str};
-            }
-            else {
-               return pair{json_error::number_too_large, string{""}};
+         return parse_member<I>();
+      }
+   }
+
+private:
+   inline static constexpr auto& table_ = detail::json_member_spans<Str>;
+
+   static constexpr std::size_t find(std::string_view name) noexcept
+   {
+      const auto str = std::string_view{Str.begin(), Str.size()};
+      const auto loc = std::ranges::find_if(table_.members, [&](const detail::json_member_span& member) {
+         return str.substr(member.name_offset, member.name_length) == name;
+      });
+      return static_cast<std::size_t>(loc - table_.members.begin());
+   }
+
+   template<std::size_t I>
+   static consteval auto parse_member() noexcept
+   {
+      constexpr auto member = table_.members[I];
+      return parse_json<Str.template splice<member.value_offset, member.value_offset + member.value_length>()>();
+   }
+};
+
+/// @brief A lazy_json handle to the document Str
+template<string Str>
+consteval auto parse_json_lazy() noexcept
+{
+   return lazy_json<Str>{};
+}
+
+namespace detail {
+
+// The first 18 decimal digits of a finite positive double followed by a digit that's only zero if all the rest are;
+// exponent is the power of ten of the first digit
+constexpr void leading_decimal_digits(double value, std::string& digits, int& exponent) noexcept
+{
+   constexpr std::uint32_t limb_base = 1'000'000'000;
+   const auto bits = std::bit_cast<std::uint64_t>(value);
+   const auto biased_exponent = static_cast<int>(bits >> 52);
+   auto mantissa = bits & ((std::uint64_t{1} << 52) - 1);
+   auto exponent2 = -1074;
+   if (biased_exponent != 0) {
+      mantissa |= std::uint64_t{1} << 52;
+      exponent2 = biased_exponent - 1075;
+   }
+   // value is mantissa * 2^exponent2, which is mantissa * 5^-exponent2 / 10^-exponent2 for negative exponents, so
+   // both cases come down to the digits of an integer. The integer is kept as base 10^9 limbs, least significant
+   // first.
+   std::vector<std::uint32_t> limbs{
+      static_cast<std::uint32_t>(mantissa % limb_base),
+      static_cast<std::uint32_t>(mantissa / limb_base % limb_base),
+      static_cast<std::uint32_t>(mantissa / limb_base / limb_base)};
+   const auto multiply = [&](std::uint32_t factor) {
+      std::uint64_t carry = 0;
+      for (auto& limb : limbs) {
+         carry += std::uint64_t{limb} * factor;
+         limb = static_cast<std::uint32_t>(carry % limb_base);
+         carry /= limb_base;
+      }
+      // The carry can be larger than a limb as 5^13 is larger than 10^9
+      for (; carry != 0; carry /= limb_base) {
+         limbs.push_back(static_cast<std::uint32_t>(carry % limb_base));
+      }
+   };
+   // Multiply by as large a power as fits in a limb at once
+   for (auto remaining = exponent2 > 0 ? exponent2 : -exponent2; remaining > 0; remaining -= exponent2 > 0 ? 29 : 13) {
+      const auto batch = std::min(remaining, exponent2 > 0 ? 29 : 13);
+      std::uint32_t factor = 1;
+      for (int i = 0; i < batch; ++i) {
+         factor *= exponent2 > 0 ? 2 : 5;
+      }
+      multiply(factor);
+   }
+   while (limbs.back() == 0) {
+      limbs.pop_back();
+   }
+   digits.clear();
+   for (auto limb = limbs.rbegin(); limb != limbs.rend(); ++limb) {
+      char limb_digits[9];
+      for (auto& c : limb_digits | std::views::reverse) {
+         c = static_cast<char>('0' + *limb % 10);
+         *limb /= 10;
+      }
+      digits.append(limb_digits, 9);
+   }
+   digits.erase(0, digits.find_first_not_of('0'));
+   exponent = static_cast<int>(digits.size()) - 1 + std::min(exponent2, 0);
+   // Rounding to at most 17 digits only needs the digit after them and whether any later digit isn't zero, so the
+   // hundreds of digits of very small or large values aren't carried into rounding
+   if (digits.size() > 19) {
+      const auto sticky = digits.find_first_not_of('0', 18) != std::string::npos;
+      digits.resize(18);
+      digits += sticky ? '1' : '0';
+   }
+}
+
+// Rounds the digits (half to even) to count digits, which may carry into a new first digit
+constexpr void round_decimal_digits(std::string& digits, int& exponent, std::size_t count) noexcept
+{
+   if (digits.size() <= count) {
+      return;
+   }
+   const auto rest = std::string_view{digits}.substr(count);
+   const auto is_odd = count != 0 && (digits[count - 1] - '0') % 2 == 1;
+   const auto round_up
+      = rest[0] > '5' || (rest[0] == '5' && (rest.find_first_not_of('0', 1) != std::string_view::npos || is_odd));
+   digits.resize(count);
+   if (round_up) {
+      auto i = count;
+      while (i != 0 && digits[i - 1] == '9') {
+         digits[--i] = '0';
+      }
+      if (i == 0) {
+         digits.insert(digits.begin(), '1');
+         digits.pop_back();
+         ++exponent;
+      }
+      else {
+         ++digits[i - 1];
+      }
+   }
+}
+
+// Writes the shortest digits that to_double reads back as value, always with a '.' or an exponent so it's read back
+// as a double
+constexpr void append_json_double(std::string& out, double value)
+{
+   if (value != value || value == std::numeric_limits<double>::infinity()
+       || value == -std::numeric_limits<double>::infinity()) {
+      compile_time_error("JSON has no infinities or NaN");
+   }
+   if (std::bit_cast<std::uint64_t>(value) >> 63 != 0) {
+      out += '-';
+      value = -value;
+   }
+   if (value == 0) {
+      out += "0.0";
+      return;
+   }
+   std::string leading;
+   int leading_exponent = 0;
+   leading_decimal_digits(value, leading, leading_exponent);
+   std::string digits;
+   int exponent = 0;
+   for (std::size_t count = 1;; ++count) {
+      digits = leading;
+      exponent = leading_exponent;
+      round_decimal_digits(digits, exponent, count);
+      digits.erase(std::min(digits.find_last_not_of('0') + 1, digits.size()));
+      auto scientific = digits.substr(0, 1) + "." + digits.substr(1) + "0e";
+      if (exponent < 0) {
+         scientific += '-';
+      }
+      std::string exponent_digits;
+      for (auto e = exponent < 0 ? -exponent : exponent; exponent_digits.empty() || e != 0; e /= 10) {
+         exponent_digits.insert(exponent_digits.begin(), static_cast<char>('0' + e % 10));
+      }
+      // 17 digits always read back as the same double
+      if (count == 17 || to_double(scientific + exponent_digits) == value) {
+         if (exponent < -5 || exponent >= 21) {
+            out += digits[0];
+            if (digits.size() != 1) {
+               out += '.';
+               out.append(digits, 1);
             }
+            out += 'e';
+            out += exponent < 0 ? "-" : "";
+            out += exponent_digits;
+         }
+         else if (exponent < 0) {
+            out += "0.";
+            out.append(static_cast<std::size_t>(-exponent - 1), '0');
+            out += digits;
          }
          else {
-            constexpr auto val = to_unsigned_num<Str>(std::numeric_limits<std::uint64_t>::max());
-            if constexpr (val) {
-               return pair{*val, ret_str};
-            }
-            else {
-               return pair{json_error::number_too_large, string{""}};
-            }
+            const auto integer_size = static_cast<std::size_t>(exponent) + 1;
+            digits.resize(std::max(digits.size(), integer_size), '0');
+            out.append(digits, 0, integer_size);
+            out += '.';
+            const auto fraction = std::string_view{digits}.substr(integer_size);
+            out += fraction.empty() ? "0" : fraction;
          }
+         return;
+      }
+   }
+}
+
+template<typename T>
+constexpr void append_json(std::string& out, const T& value);
+
+template<
+   typename Key,
+   typename Comp,
+   std::size_t Size,
+   std::array<Key, Size> Keys,
+   std::array<std::size_t, Size> Mapping,
+   auto... Values>
+constexpr void append_json_object(std::string& out, const multi_type_map<Key, Comp, Size, Keys, Mapping, Values...>&)
+{
+   static_assert(is_string<Key> || is_json_name<Key>, "JSON object member names have to be strings");
+   out += '{';
+   [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+      ((out += Is == 0 ? "\"" : ",\"",
+        out += runtime_key<Key>::from(Keys[Is]),
+        out += "\":",
+        append_json(out, multi_type_map<Key, Comp, Size, Keys, Mapping, Values...>::template get_at<Is>())),
+       ...);
+   }(std::make_index_sequence<Size>{});
+   out += '}';
+}
+
+template<typename T>
+constexpr void append_json(std::string& out, const T& value)
+{
+   if constexpr (std::same_as<T, std::uint64_t> || std::same_as<T, std::int64_t>) {
+      if (value < 0) {
+         out += '-';
       }
+      // Negate as unsigned so the magnitude of the lowest value doesn't overflow
+      auto magnitude = value < 0 ? 0 - static_cast<std::uint64_t>(value) : static_cast<std::uint64_t>(value);
+      char digits[20];
+      auto first = std::end(digits);
+      do {
+         *--first = static_cast<char>('0' + magnitude % 10);
+         magnitude /= 10;
+      } while (magnitude != 0);
+      out.append(first, std::end(digits));
+   }
+   else if constexpr (std::same_as<T, double>) {
+      append_json_double(out, value);
    }
-   else if constexpr (std::string_view(Str.value_).starts_with("true")) {
-      return pair{true_, Str | splice<4, Str.size()>};
+   else if constexpr (std::same_as<T, true_struct>) {
+      out += "true";
    }
-   else if constexpr (std::string_view(Str.value_).starts_with("false")) {
-      return pair{false_, Str | splice<5, Str.size()>};
+   else if constexpr (std::same_as<T, false_struct>) {
+      out += "false";
    }
-   else if constexpr (std::string_view(Str.value_).starts_with("null")) {
-      return pair{null, Str | splice<4, Str.size()>};
+   else if constexpr (std::same_as<T, null_struct>) {
+      out += "null";
    }
-   else if constexpr (Str[0] == '"') {
-      return parse_json_string<Str>();
+   else if constexpr (is_tuple<T>) {
+      out += '[';
+      [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+         ((out += Is == 0 ? "" : ",", append_json(out, value.template get<Is>())), ...);
+      }(std::make_index_sequence<T::size>{});
+      out += ']';
+   }
+   else if constexpr (requires { append_json_object(out, value); }) {
+      append_json_object(out, value);
    }
    else {
-      return pair{json_error::unexpected_input, string{""}};
+      // Escapes are kept as is in parsed strings
+      out += '"';
+      out += std::string_view{value.begin(), value.size()};
+      out += '"';
    }
 }
 
 } // namespace detail
 
+/// @brief Turns what parse_json gives back into minified JSON, as a string
+///
+/// Object members come out sorted by name, as that's how they're stored. Doubles are written with the fewest digits
+/// that read back as the same value; infinities and NaN, which JSON can't represent, don't compile.
+template<auto Value>
+   requires(!is_json_error(Value))
+consteval auto to_json_string() noexcept
+{
+   constexpr auto size = []() {
+      std::string out;
+      detail::append_json(out, Value);
+      return out.size();
+   }();
+   std::string out;
+   detail::append_json(out, Value);
+   string<size + 1> to_ret;
+   std::ranges::copy(out, to_ret.begin());
+   return to_ret;
+}
+
+namespace detail {
+template<bool Members>
+struct json_child_iterator;
+} // namespace detail
+
+/// @brief A value of a json_dom; only valid as long as the json_dom and the input it parsed are
+struct json_value {
+   constexpr json_kind kind() const noexcept { return token().kind; }
+
+   // The characters of the value; for strings this excludes the quotes and escapes are kept as is, like parse_json
+   constexpr std::string_view text() const noexcept { return input_.substr(token().offset, token().length); }
+
+   constexpr std::optional<std::string_view> as_string() const noexcept
+   {
+      if (kind() != json_kind::string) {
+         return std::nullopt;
+      }
+      return text();
+   }
+
+   constexpr std::optional<std::uint64_t> as_unsigned() const noexcept
+   {
+      if (kind() != json_kind::unsigned_integer) {
+         return std::nullopt;
+      }
+      return detail::to_unsigned_num(text(), std::numeric_limits<std::uint64_t>::max());
+   }
+
+   // Also gives unsigned integers that fit
+   constexpr std::optional<std::int64_t> as_signed() const noexcept
+   {
+      if (kind() != json_kind::signed_integer && kind() != json_kind::unsigned_integer) {
+         return std::nullopt;
+      }
+      return detail::to_signed_num(text());
+   }
+
+   // Also gives integers
+   constexpr std::optional<double> as_double() const noexcept
+   {
+      if (kind() != json_kind::floating && kind() != json_kind::signed_integer
+          && kind() != json_kind::unsigned_integer) {
+         return std::nullopt;
+      }
+      return detail::to_double(text());
+   }
+
+   constexpr std::optional<bool> as_bool() const noexcept
+   {
+      if (kind() != json_kind::true_ && kind() != json_kind::false_) {
+         return std::nullopt;
+      }
+      return kind() == json_kind::true_;
+   }
+
+   constexpr bool is_null() const noexcept { return kind() == json_kind::null; }
+
+   // The number of elements of an array or members of an object
+   constexpr std::size_t size() const noexcept { return token().child_count; }
+
+   // Walks the elements before index, skipping over their children
+   constexpr std::optional<json_value> operator[](std::size_t index) const noexcept
+   {
+      if (kind() != json_kind::array || index >= size()) {
+         return std::nullopt;
+      }
+      auto child = index_ + 1;
+      for (; index != 0; --index) {
+         child = tokens_[child].next;
+      }
+      return json_value{input_, tokens_, child};
+   }
+
+   // Gives the first member named key
+   constexpr std::optional<json_value> operator[](std::string_view key) const noexcept
+   {
+      if (kind() != json_kind::object) {
+         return std::nullopt;
+      }
+      for (auto name = index_ + 1; name != token().next; name = tokens_[name + 1].next) {
+         if (input_.substr(tokens_[name].offset, tokens_[name].length) == key) {
+            return json_value{input_, tokens_, name + 1};
+         }
+      }
+      return std::nullopt;
+   }
+
+   // The elements of an array as json_values
+   constexpr auto elements() const noexcept;
+
+   // The members of an object as pairs of the name and the value
+   constexpr auto members() const noexcept;
+
+private:
+   friend struct json_dom;
+   template<std::size_t NodeCapacity, std::size_t CharCapacity>
+   friend struct json_document;
+   template<bool Members>
+   friend struct detail::json_child_iterator;
+
+   constexpr json_value(std::string_view input, const detail::json_token* tokens, std::size_t index) noexcept
+      : input_{input}, tokens_{tokens}, index_{index}
+   {}
+
+   constexpr const detail::json_token& token() const noexcept { return tokens_[index_]; }
+
+   std::string_view input_;
+   const detail::json_token* tokens_;
+   std::size_t index_;
+};
+
+namespace detail {
+
+// Iterates the elements of an array or, if Members is true, the members of an object
+template<bool Members>
+struct json_child_iterator {
+   using value_type = std::conditional_t<Members, pair<std::string_view, json_value>, json_value>;
+   using difference_type = std::ptrdiff_t;
+
+   constexpr value_type operator*() const noexcept
+   {
+      if constexpr (Members) {
+         return {input_.substr(tokens_[index_].offset, tokens_[index_].length), {input_, tokens_, index_ + 1}};
+      }
+      else {
+         return {input_, tokens_, index_};
+      }
+   }
+
+   constexpr json_child_iterator& operator++() noexcept
+   {
+      index_ = tokens_[index_ + Members].next;
+      return *this;
+   }
+
+   constexpr json_child_iterator operator++(int) noexcept
+   {
+      auto to_ret = *this;
+      ++*this;
+      return to_ret;
+   }
+
+   friend constexpr bool operator==(const json_child_iterator& lhs, const json_child_iterator& rhs) noexcept
+   {
+      return lhs.index_ == rhs.index_;
+   }
+
+   std::string_view input_;
+   const json_token* tokens_ = nullptr;
+   std::size_t index_ = 0;
+};
+
+template<bool Members>
+struct json_children_range {
+   constexpr auto begin() const noexcept { return begin_; }
+   constexpr auto end() const noexcept { return end_; }
+
+   json_child_iterator<Members> begin_;
+   json_child_iterator<Members> end_;
+};
+
+} // namespace detail
+
+// Arrays other than the one this was called on are iterated as if they were empty
+constexpr auto json_value::elements() const noexcept
+{
+   const auto end = kind() == json_kind::array ? token().next : index_ + 1;
+   return detail::json_children_range<false>{{input_, tokens_, index_ + 1}, {input_, tokens_, end}};
+}
+
+constexpr auto json_value::members() const noexcept
+{
+   const auto end = kind() == json_kind::object ? token().next : index_ + 1;
+   return detail::json_children_range<true>{{input_, tokens_, index_ + 1}, {input_, tokens_, end}};
+}
+
+/// @brief Parses JSON at runtime (or during constant evaluation) with the same grammar and errors as parse_json
+///
+/// All values are stored contiguously in one buffer in document order and strings refer to the input, so the input
+/// has to outlive the json_dom. The buffer is reused when parsing again, so a json_dom used for many documents stops
+/// allocating once it has grown to fit the largest one.
+struct json_dom {
+   constexpr json_dom() noexcept = default;
+
+   constexpr explicit json_dom(std::string_view input) { parse(input); }
+
+   constexpr json_status parse(std::string_view input)
+   {
+      input_ = input;
+      tokens_.clear();
+      status_ = detail::tokenize_json(input, tokens_);
+      return status_;
+   }
+
+   constexpr json_status status() const noexcept { return status_; }
+
+   // Pre: status() == json_status::ok
+   constexpr json_value root() const noexcept { return {input_, tokens_.data(), 0}; }
+
+private:
+   std::string_view input_;
+   std::vector<detail::json_token> tokens_;
+   json_status status_ = json_status::unexpected_end_of_input;
+};
+
+/// @brief A parsed document held by value in fixed capacity arrays, so it can be a constexpr variable
+///
+/// Like json_dom the values are stored in document order with an index to the one after each, but the characters of
+/// strings, numbers and member names are copied into the document so it doesn't refer to the input. Objects and
+/// arrays have empty text(). However large the document is, it's one type with no type per value; a document that
+/// doesn't fit gives json_status::capacity_exceeded.
+///
+///   static constexpr json_document<3, 8> doc{R"({"port": 80})"};
+///   doc.root()["port"]->as_unsigned() == 80u
+template<std::size_t NodeCapacity, std::size_t CharCapacity>
+struct json_document {
+   constexpr json_document() noexcept = default;
+
+   constexpr explicit json_document(std::string_view input) { parse(input); }
+
+   constexpr json_status parse(std::string_view input)
+   {
+      std::vector<detail::json_token> tokens;
+      status_ = detail::tokenize_json(input, tokens);
+      node_count_ = 0;
+      char_count_ = 0;
+      for (auto token : tokens) {
+         if (token.kind == json_kind::object || token.kind == json_kind::array) {
+            token.length = 0;
+         }
+         if (node_count_ == NodeCapacity || token.length > CharCapacity - char_count_) {
+            node_count_ = 0;
+            char_count_ = 0;
+            status_ = json_status::capacity_exceeded;
+            return status_;
+         }
+         std::copy_n(input.begin() + token.offset, token.length, chars_.begin() + char_count_);
+         token.offset = char_count_;
+         char_count_ += token.length;
+         nodes_[node_count_++] = token;
+      }
+      return status_;
+   }
+
+   constexpr json_status status() const noexcept { return status_; }
+
+   // The number of values and member names, and how many characters of the capacity they use
+   constexpr std::size_t node_count() const noexcept { return node_count_; }
+   constexpr std::size_t char_count() const noexcept { return char_count_; }
+
+   // Pre: status() == json_status::ok
+   constexpr json_value root() const noexcept { return {{chars_.data(), char_count_}, nodes_.data(), 0}; }
+
+private:
+   std::array<detail::json_token, NodeCapacity> nodes_{};
+   std::array<char, CharCapacity> chars_{};
+   std::size_t node_count_ = 0;
+   std::size_t char_count_ = 0;
+   json_status status_ = json_status::unexpected_end_of_input;
+};
+
+/// @brief The document Str as a json_document with exactly the capacity it needs
 template<string Str>
-consteval auto parse_json() noexcept
+consteval auto make_json_document() noexcept
 {
-   constexpr auto ret_val_and_rest = detail::parse_json_value<strip_leading_whitespace<Str>()>();
-   constexpr auto rest = ret_val_and_rest.second;
-   if constexpr (strip_leading_whitespace<rest>().empty()) {
-      return ret_val_and_rest.first;
+   constexpr auto str = std::string_view{Str.begin(), Str.size()};
+   constexpr auto sizes = [&]() {
+      std::vector<detail::json_token> tokens;
+      detail::tokenize_json(str, tokens);
+      std::size_t char_count = 0;
+      for (const auto& token : tokens) {
+         char_count += token.kind == json_kind::object || token.kind == json_kind::array ? 0 : token.length;
+      }
+      return pair{tokens.size(), char_count};
+   }();
+   return json_document<sizes.first, sizes.second>{str};
+}
+
+namespace detail {
+
+// Writes the count low bytes of value, little endian
+constexpr void write_le(std::span<char> out, std::size_t pos, std::uint64_t value, std::size_t count) noexcept
+{
+   for (std::size_t i = 0; i < count; ++i) {
+      out[pos + i] = static_cast<char>(value >> (8 * i) & 0xff);
+   }
+}
+
+// Varints are unsigned LEB128: seven bits a byte, lowest first, with the top bit set on every byte but the last
+constexpr std::size_t varint_size(std::uint64_t value) noexcept
+{
+   std::size_t to_ret = 1;
+   for (; value >= 0x80; value >>= 7) {
+      ++to_ret;
+   }
+   return to_ret;
+}
+
+// Gives the position after the varint
+constexpr std::size_t write_varint(std::span<char> out, std::size_t pos, std::uint64_t value) noexcept
+{
+   for (; value >= 0x80; value >>= 7) {
+      out[pos++] = static_cast<char>((value & 0x7f) | 0x80);
+   }
+   out[pos++] = static_cast<char>(value);
+   return pos;
+}
+
+// The number of bytes of value once its leading zero bytes are dropped
+constexpr std::size_t significant_bytes(std::uint64_t value) noexcept
+{
+   std::size_t to_ret = 0;
+   for (; value != 0; value >>= 8) {
+      ++to_ret;
+   }
+   return to_ret;
+}
+
+// Negative integers are stored as -1 - value, so numbers close to zero are small either way
+constexpr std::uint64_t json_binary_integer(std::string_view text, json_kind kind) noexcept
+{
+   if (kind == json_kind::unsigned_integer) {
+      return *to_unsigned_num(text, std::numeric_limits<std::uint64_t>::max());
+   }
+   return ~static_cast<std::uint64_t>(*to_signed_num(text));
+}
+
+constexpr bool is_exact_float(double value) noexcept
+{
+   // Converting a double outside the range of float isn't a constant expression
+   return value >= -std::numeric_limits<float>::max() && value <= std::numeric_limits<float>::max()
+       && static_cast<double>(static_cast<float>(value)) == value;
+}
+
+// Every value starts with a tag byte, its json_kind in the low four bits and a number in the high four, followed by
+//   - for integers, nothing if the number is below 8 as it's the integer itself, otherwise the integer in as many
+//     little endian bytes as the number is above 7. Negative integers store -1 - value instead;
+//   - for doubles, the bits of the value as a float in 4 bytes if the number is 1 and as a double in 8 bytes if it's 0;
+//   - for strings, the characters if the number is below 15, as it's their length, otherwise the length as a varint
+//     and then the characters;
+//   - for arrays and objects, the element or member count as a varint and then the offset of each element, or of each
+//     member's name sorted by name, in 2^number little endian bytes. A member's value follows its name.
+// Offsets are from the start of the array or object holding them, which uses the narrowest width that reaches
+// everything inside it. Values are written in document order.
+struct json_binary_head {
+   std::uint8_t tag;
+   // Not counting the values inside an array or object
+   std::size_t size;
+};
+
+constexpr std::vector<json_binary_head> json_binary_heads(std::string_view str, std::span<const json_token> tokens)
+{
+   std::vector<json_binary_head> heads(tokens.size());
+   // The size of each value with everything inside it, which an array or object needs for its offset width, so the
+   // tokens are gone through from the last
+   std::vector<std::size_t> totals(tokens.size());
+   for (auto i = tokens.size(); i-- != 0;) {
+      const auto& token = tokens[i];
+      const auto text = str.substr(token.offset, token.length);
+      std::size_t number = 0;
+      std::size_t size = 1;
+      std::size_t inside = 0;
+      if (token.kind == json_kind::object || token.kind == json_kind::array) {
+         for (auto child = i + 1; child != token.next; child = tokens[child].next) {
+            inside += totals[child];
+         }
+         const auto table_size = [&] { return varint_size(token.child_count) + (token.child_count << number); };
+         while (number < 2 && size + table_size() + inside > std::uint64_t{1} << (8 << number)) {
+            ++number;
+         }
+         size += table_size();
+      }
+      else if (token.kind == json_kind::string) {
+         number = std::min<std::size_t>(token.length, 15);
+         size += (number == 15 ? varint_size(token.length) : 0) + token.length;
+      }
+      else if (token.kind == json_kind::unsigned_integer || token.kind == json_kind::signed_integer) {
+         const auto value = json_binary_integer(text, token.kind);
+         number = value < 8 ? value : 7 + significant_bytes(value);
+         size += value < 8 ? 0 : significant_bytes(value);
+      }
+      else if (token.kind == json_kind::floating) {
+         number = is_exact_float(to_double(text)) ? 1 : 0;
+         size += number == 1 ? 4 : 8;
+      }
+      heads[i] = {static_cast<std::uint8_t>(number << 4 | static_cast<std::size_t>(token.kind)), size};
+      totals[i] = size + inside;
+   }
+   return heads;
+}
+
+// Pre: tokens is a whole document that tokenized successfully and out is the sum of the json_binary_heads sizes
+constexpr void encode_json_binary(std::string_view str, std::span<const json_token> tokens, std::span<char> out)
+{
+   const auto text = [&](std::size_t index) { return str.substr(tokens[index].offset, tokens[index].length); };
+   const auto heads = json_binary_heads(str, tokens);
+   std::vector<std::size_t> offsets(tokens.size());
+   for (std::size_t i = 0, offset = 0; i != tokens.size(); offset += heads[i].size, ++i) {
+      offsets[i] = offset;
+   }
+   std::vector<std::pair<std::string_view, std::size_t>> names;
+   for (std::size_t i = 0; i != tokens.size(); ++i) {
+      const auto& token = tokens[i];
+      const auto number = std::size_t{heads[i].tag} >> 4;
+      auto pos = offsets[i];
+      out[pos++] = static_cast<char>(heads[i].tag);
+      if (token.kind == json_kind::array) {
+         pos = write_varint(out, pos, token.child_count);
+         for (auto child = i + 1; child != token.next; child = tokens[child].next, pos += std::size_t{1} << number) {
+            write_le(out, pos, offsets[child] - offsets[i], std::size_t{1} << number);
+         }
+      }
+      else if (token.kind == json_kind::object) {
+         pos = write_varint(out, pos, token.child_count);
+         names.clear();
+         for (auto name = i + 1; name != token.next; name = tokens[name + 1].next) {
+            names.emplace_back(text(name), name);
+         }
+         // Members with the same name stay in document order, so the first is the one found
+         std::ranges::sort(names);
+         for (const auto& member : names) {
+            write_le(out, pos, offsets[member.second] - offsets[i], std::size_t{1} << number);
+            pos += std::size_t{1} << number;
+         }
+      }
+      else if (token.kind == json_kind::string) {
+         if (number == 15) {
+            pos = write_varint(out, pos, token.length);
+         }
+         std::ranges::copy(text(i), out.begin() + pos);
+      }
+      else if (token.kind == json_kind::unsigned_integer || token.kind == json_kind::signed_integer) {
+         if (number >= 8) {
+            write_le(out, pos, json_binary_integer(text(i), token.kind), number - 7);
+         }
+      }
+      else if (token.kind == json_kind::floating) {
+         const auto value = to_double(text(i));
+         if (number == 1) {
+            write_le(out, pos, std::bit_cast<std::uint32_t>(static_cast<float>(value)), 4);
+         }
+         else {
+            write_le(out, pos, std::bit_cast<std::uint64_t>(value), 8);
+         }
+      }
+   }
+}
+
+} // namespace detail
+
+/// @brief A value of a json_binary, read in place; only valid as long as the json_binary is
+///
+/// Elements of arrays are found with one load of their offset and members of objects with a binary search of the
+/// sorted names, so nothing is decoded ahead of time and only the bytes on the way to a value are read.
+struct json_binary_value {
+   constexpr json_kind kind() const noexcept { return static_cast<json_kind>(tag() & 0x0f); }
+
+   // Escapes are kept as is, like parse_json
+   constexpr std::optional<std::string_view> as_string() const noexcept
+   {
+      if (kind() != json_kind::string) {
+         return std::nullopt;
+      }
+      return string_at(offset_);
+   }
+
+   constexpr std::optional<std::uint64_t> as_unsigned() const noexcept
+   {
+      if (kind() != json_kind::unsigned_integer) {
+         return std::nullopt;
+      }
+      return integer();
+   }
+
+   // Also gives unsigned integers that fit
+   constexpr std::optional<std::int64_t> as_signed() const noexcept
+   {
+      if (kind() == json_kind::signed_integer) {
+         return static_cast<std::int64_t>(~integer());
+      }
+      if (kind() != json_kind::unsigned_integer || integer() > std::numeric_limits<std::int64_t>::max()) {
+         return std::nullopt;
+      }
+      return static_cast<std::int64_t>(integer());
+   }
+
+   // Also gives integers
+   constexpr std::optional<double> as_double() const noexcept
+   {
+      if (kind() == json_kind::floating) {
+         if (number() == 1) {
+            return static_cast<double>(std::bit_cast<float>(detail::read_le<std::uint32_t>(bytes_ + offset_ + 1)));
+         }
+         return std::bit_cast<double>(detail::read_le<std::uint64_t>(bytes_ + offset_ + 1));
+      }
+      if (kind() == json_kind::signed_integer) {
+         return static_cast<double>(static_cast<std::int64_t>(~integer()));
+      }
+      if (kind() == json_kind::unsigned_integer) {
+         return static_cast<double>(integer());
+      }
+      return std::nullopt;
+   }
+
+   constexpr std::optional<bool> as_bool() const noexcept
+   {
+      if (kind() != json_kind::true_ && kind() != json_kind::false_) {
+         return std::nullopt;
+      }
+      return kind() == json_kind::true_;
+   }
+
+   constexpr bool is_null() const noexcept { return kind() == json_kind::null; }
+
+   // The number of elements of an array or members of an object
+   constexpr std::size_t size() const noexcept
+   {
+      auto pos = offset_ + 1;
+      return kind() == json_kind::object || kind() == json_kind::array ? read_varint(pos) : 0;
+   }
+
+   constexpr std::optional<json_binary_value> operator[](std::size_t index) const noexcept
+   {
+      if (kind() != json_kind::array) {
+         return std::nullopt;
+      }
+      auto table = offset_ + 1;
+      if (index >= read_varint(table)) {
+         return std::nullopt;
+      }
+      return json_binary_value{bytes_, entry(table, index)};
+   }
+
+   // Gives the first member named key
+   constexpr std::optional<json_binary_value> operator[](std::string_view key) const noexcept
+   {
+      if (kind() != json_kind::object) {
+         return std::nullopt;
+      }
+      auto table = offset_ + 1;
+      const auto size = read_varint(table);
+      std::size_t first = 0;
+      for (auto count = size; count != 0;) {
+         const auto half = count / 2;
+         if (member_at(table, first + half).first < key) {
+            first += half + 1;
+            count -= half + 1;
+         }
+         else {
+            count = half;
+         }
+      }
+      if (first == size || member_at(table, first).first != key) {
+         return std::nullopt;
+      }
+      return member_at(table, first).second;
+   }
+
+   // The member at index in name order
+   // Pre: kind() == json_kind::object && index < size()
+   constexpr pair<std::string_view, json_binary_value> member(std::size_t index) const noexcept
+   {
+      auto table = offset_ + 1;
+      read_varint(table);
+      return member_at(table, index);
+   }
+
+private:
+   template<std::size_t Size>
+   friend struct json_binary;
+
+   constexpr json_binary_value(const char* bytes, std::size_t offset) noexcept : bytes_{bytes}, offset_{offset} {}
+
+   constexpr std::size_t tag() const noexcept { return static_cast<unsigned char>(bytes_[offset_]); }
+
+   // The number in the high bits of the tag; see detail::json_binary_heads for what it means for each kind
+   constexpr std::size_t number() const noexcept { return tag() >> 4; }
+
+   constexpr std::uint64_t read_uint(std::size_t pos, std::size_t count) const noexcept
+   {
+      std::uint64_t to_ret = 0;
+      for (std::size_t i = 0; i < count; ++i) {
+         to_ret |= std::uint64_t{static_cast<unsigned char>(bytes_[pos + i])} << (8 * i);
+      }
+      return to_ret;
+   }
+
+   // Moves pos past the varint
+   constexpr std::uint64_t read_varint(std::size_t& pos) const noexcept
+   {
+      std::uint64_t to_ret = 0;
+      for (std::size_t shift = 0;; shift += 7) {
+         const auto byte = static_cast<unsigned char>(bytes_[pos++]);
+         to_ret |= std::uint64_t{byte & 0x7fu} << shift;
+         if (byte < 0x80) {
+            return to_ret;
+         }
+      }
+   }
+
+   constexpr std::uint64_t integer() const noexcept
+   {
+      return number() < 8 ? number() : read_uint(offset_ + 1, number() - 7);
+   }
+
+   constexpr std::string_view string_at(std::size_t pos) const noexcept
+   {
+      std::size_t length = static_cast<unsigned char>(bytes_[pos++]) >> 4;
+      if (length == 15) {
+         length = read_varint(pos);
+      }
+      return {bytes_ + pos, length};
+   }
+
+   // The offset of the value at index of the table of this array or object
+   constexpr std::size_t entry(std::size_t table, std::size_t index) const noexcept
+   {
+      return offset_ + read_uint(table + (index << number()), std::size_t{1} << number());
+   }
+
+   constexpr pair<std::string_view, json_binary_value> member_at(std::size_t table, std::size_t index) const noexcept
+   {
+      const auto name = string_at(entry(table, index));
+      return {name, {bytes_, static_cast<std::size_t>(name.data() + name.size() - bytes_)}};
+   }
+
+   const char* bytes_;
+   std::size_t offset_;
+};
+
+/// @brief A document encoded at compile time into a compact binary form that's read without decoding it first
+///
+/// As a static constexpr variable the bytes live in read only memory and reading a value never allocates; see
+/// detail::json_binary_heads for the format.
+template<std::size_t Size>
+struct json_binary {
+   constexpr json_binary_value root() const noexcept { return json_binary_value{bytes.data(), 0}; }
+
+   std::array<char, Size> bytes;
+};
+
+/// @brief The document Str encoded as a json_binary, or the json_error if it's invalid
+template<string Str>
+consteval auto make_json_binary() noexcept
+{
+   constexpr auto& tokens = detail::json_tokens<Str>;
+   if constexpr (tokens.status != json_status::ok) {
+      return detail::to_json_error<tokens.status>();
    }
    else {
-      return json_error::remaining_input;
+      constexpr auto size = [&]() {
+         std::size_t to_ret = 0;
+         for (const auto& head : detail::json_binary_heads(std::string_view{Str.begin(), Str.size()}, tokens.tokens)) {
+            to_ret += head.size;
+         }
+         return to_ret;
+      }();
+      static_assert(size <= std::numeric_limits<std::uint32_t>::max(), "Offsets are 32 bits");
+      json_binary<size> to_ret{};
+      detail::encode_json_binary(std::string_view{Str.begin(), Str.size()}, tokens.tokens, to_ret.bytes);
+      return to_ret;
    }
 }
 
+/// @brief What parse_json gave encoded as a json_binary; object members come out sorted by name, as with
+/// to_json_string
+template<auto Value>
+   requires(!is_json_error(Value))
+consteval auto to_json_binary() noexcept
+{
+   return make_json_binary<to_json_string<Value>()>();
+}
+
 } // namespace khct
 
 #endif // KHCT_JSON_HPP
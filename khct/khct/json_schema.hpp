@@ -0,0 +1,550 @@
+#ifndef KHCT_JSON_SCHEMA_HPP
+#define KHCT_JSON_SCHEMA_HPP
+
+#include <khct/common.hpp>
+#include <khct/format.hpp>
+#include <khct/json.hpp>
+#include <khct/map.hpp>
+#include <khct/string.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace khct {
+
+template<string Schema, std::size_t Index = 0>
+struct json_record;
+
+namespace detail {
+
+// Reads a document one value at a time without building anything but what it's reading into
+struct json_reader {
+   constexpr void skip_ws() noexcept
+   {
+      while (pos != str.size() && is_ws(str[pos])) {
+         ++pos;
+      }
+   }
+
+   // Skips whitespace and then c if it's next
+   constexpr bool consume(char c) noexcept
+   {
+      skip_ws();
+      if (pos != str.size() && str[pos] == c) {
+         ++pos;
+         return true;
+      }
+      return false;
+   }
+
+   // The error for when something other than what was expected is next
+   constexpr json_status unexpected() noexcept
+   {
+      skip_ws();
+      return pos == str.size() ? json_status::unexpected_end_of_input : json_status::unexpected_input;
+   }
+
+   constexpr json_status expect(char c) noexcept { return consume(c) ? json_status::ok : unexpected(); }
+
+   constexpr json_status read_string(std::string_view& out) noexcept
+   {
+      skip_ws();
+      if (pos == str.size() || str[pos] != '"') {
+         return unexpected();
+      }
+      const auto end = find_json_string_end(str, pos);
+      if (end == std::string_view::npos) {
+         return json_status::invalid_string;
+      }
+      out = str.substr(pos + 1, end - pos - 1);
+      pos = end + 1;
+      return json_status::ok;
+   }
+
+   // Reads a number of any kind, which is checked like parse_json checks it
+   constexpr json_status read_number(std::string_view& out, json_kind& kind) noexcept
+   {
+      skip_ws();
+      if (pos == str.size() || (str[pos] != '-' && !is_num(str[pos]))) {
+         return unexpected();
+      }
+      out = str.substr(pos, json_number_length(str.substr(pos)));
+      const auto [status, number_kind] = check_json_number(out);
+      pos += out.size();
+      kind = number_kind;
+      return status;
+   }
+
+   constexpr json_status read_literal(std::string_view literal) noexcept
+   {
+      skip_ws();
+      if (!str.substr(pos).starts_with(literal)) {
+         return unexpected();
+      }
+      pos += literal.size();
+      return json_status::ok;
+   }
+
+   // Skips a value of a member that isn't in the schema. Objects and arrays are skipped by matching brackets
+   // (skipping over strings) without checking what's inside them.
+   constexpr json_status skip_value() noexcept
+   {
+      skip_ws();
+      if (pos == str.size()) {
+         return json_status::unexpected_end_of_input;
+      }
+      if (str[pos] == '"') {
+         std::string_view ignored;
+         return read_string(ignored);
+      }
+      if (str[pos] == '-' || is_num(str[pos])) {
+         std::string_view ignored;
+         json_kind ignored_kind;
+         return read_number(ignored, ignored_kind);
+      }
+      if (str[pos] != '{' && str[pos] != '[') {
+         for (const auto literal : std::array<std::string_view, 3>{"true", "false", "null"}) {
+            if (read_literal(literal) == json_status::ok) {
+               return json_status::ok;
+            }
+         }
+         return json_status::unexpected_input;
+      }
+      std::size_t depth = 0;
+      for (; pos != str.size(); ++pos) {
+         if (str[pos] == '"') {
+            pos = find_json_string_end(str, pos);
+            if (pos == std::string_view::npos) {
+               pos = str.size();
+               return json_status::invalid_string;
+            }
+         }
+         else if (str[pos] == '{' || str[pos] == '[') {
+            ++depth;
+         }
+         else if ((str[pos] == '}' || str[pos] == ']') && --depth == 0) {
+            ++pos;
+            return json_status::ok;
+         }
+      }
+      return json_status::unexpected_end_of_input;
+   }
+
+   std::string_view str;
+   std::size_t pos = 0;
+};
+
+// The value a value of the schema is read into, which is also its default. Numbers, booleans and null are stored
+// as what parse_json gives for them, strings as std::string_views into the document, arrays as tuples and objects
+// as json_records.
+template<string Schema, std::size_t Index>
+consteval auto make_json_schema_value() noexcept
+{
+   constexpr auto token = json_tokens<Schema>.tokens[Index];
+   constexpr auto text = std::string_view{Schema.begin() + token.offset, token.length};
+   if constexpr (token.kind == json_kind::object) {
+      return json_record<Schema, Index>{};
+   }
+   else if constexpr (token.kind == json_kind::array) {
+      constexpr auto& children = json_children<Schema, Index>;
+      return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+         return tuple{make_json_schema_value<Schema, children[Is]>()...};
+      }(std::make_index_sequence<token.child_count>{});
+   }
+   else if constexpr (token.kind == json_kind::string) {
+      return text;
+   }
+   else if constexpr (token.kind == json_kind::unsigned_integer) {
+      return *to_unsigned_num(text, std::numeric_limits<std::uint64_t>::max());
+   }
+   else if constexpr (token.kind == json_kind::signed_integer) {
+      return *to_signed_num(text);
+   }
+   else if constexpr (token.kind == json_kind::floating) {
+      return to_double(text);
+   }
+   else if constexpr (token.kind == json_kind::true_ || token.kind == json_kind::false_) {
+      return token.kind == json_kind::true_;
+   }
+   else {
+      return null;
+   }
+}
+
+template<string Schema, std::size_t Index>
+using json_schema_value_t = decltype(make_json_schema_value<Schema, Index>());
+
+// The values of the members of the object at Index, in the order of the schema
+template<string Schema, std::size_t Index>
+consteval auto make_json_record_values() noexcept
+{
+   constexpr auto& children = json_children<Schema, Index>;
+   return [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+      return tuple{make_json_schema_value<Schema, children[2 * Is + 1]>()...};
+   }(std::make_index_sequence<children.size() / 2>{});
+}
+
+template<string Schema, std::size_t Index>
+constexpr json_status read_json_schema_value(json_reader& reader, json_schema_value_t<Schema, Index>& out) noexcept
+{
+   constexpr auto kind = json_tokens<Schema>.tokens[Index].kind;
+   if constexpr (kind == json_kind::object) {
+      return out.read(reader);
+   }
+   else if constexpr (kind == json_kind::array) {
+      constexpr auto& children = json_children<Schema, Index>;
+      auto status = reader.expect('[');
+      const auto read_element = [&]<std::size_t I>() {
+         if (status == json_status::ok && I != 0) {
+            status = reader.expect(',');
+         }
+         if (status == json_status::ok) {
+            status = read_json_schema_value<Schema, children[I]>(reader, out.template get<I>());
+         }
+      };
+      [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+         (read_element.template operator()<Is>(), ...);
+      }(std::make_index_sequence<children.size()>{});
+      return status == json_status::ok ? reader.expect(']') : status;
+   }
+   else if constexpr (kind == json_kind::string) {
+      return reader.read_string(out);
+   }
+   else if constexpr (
+      kind == json_kind::unsigned_integer || kind == json_kind::signed_integer || kind == json_kind::floating) {
+      std::string_view text;
+      json_kind number_kind;
+      const auto status = reader.read_number(text, number_kind);
+      if (status != json_status::ok) {
+         return status;
+      }
+      if constexpr (kind == json_kind::unsigned_integer) {
+         if (number_kind != json_kind::unsigned_integer) {
+            return json_status::unexpected_input;
+         }
+         out = *to_unsigned_num(text, std::numeric_limits<std::uint64_t>::max());
+      }
+      else if constexpr (kind == json_kind::signed_integer) {
+         const auto value = number_kind == json_kind::floating ? std::nullopt : to_signed_num(text);
+         if (!value) {
+            return number_kind == json_kind::floating ? json_status::unexpected_input : json_status::number_too_large;
+         }
+         out = *value;
+      }
+      else {
+         out = to_double(text);
+      }
+      return json_status::ok;
+   }
+   else if constexpr (kind == json_kind::true_ || kind == json_kind::false_) {
+      if (reader.read_literal("true") == json_status::ok) {
+         out = true;
+         return json_status::ok;
+      }
+      const auto status = reader.read_literal("false");
+      if (status == json_status::ok) {
+         out = false;
+      }
+      return status;
+   }
+   else {
+      return reader.read_literal("null");
+   }
+}
+
+} // namespace detail
+
+/// @brief The members of the object at Index of the JSON document Schema, for reading documents of the same shape
+/// at runtime with read_json
+///
+/// Every member is stored directly with the type parse_json gives the schema's value for it (e.g., use 0 for an
+/// unsigned integer, -1 for a signed one and 0.0 for a double) and starts out as that value. Member names are
+/// matched with a perfect hash generated from the schema and each member is read by code specialized to its type,
+/// so no document object model is built.
+template<string Schema, std::size_t Index>
+struct json_record {
+   static_assert(detail::json_tokens<Schema>.status == json_status::ok, "The schema must be valid JSON");
+   static_assert(detail::json_tokens<Schema>.tokens[Index].kind == json_kind::object);
+
+   template<string Key>
+   constexpr auto& get() noexcept
+   {
+      static_assert(member_index<Key> != member_count, "The key isn't in the schema");
+      return values_.template get<member_index<Key>>();
+   }
+
+   template<string Key>
+   constexpr const auto& get() const noexcept
+   {
+      static_assert(member_index<Key> != member_count, "The key isn't in the schema");
+      return values_.template get<member_index<Key>>();
+   }
+
+   // Reads an object into the members, ignoring members that aren't in the schema. Members that don't appear keep
+   // their previous values.
+   constexpr json_status read(detail::json_reader& reader) noexcept
+   {
+      auto status = reader.expect('{');
+      if (status != json_status::ok || reader.consume('}')) {
+         return status;
+      }
+      while (true) {
+         std::string_view name;
+         status = reader.read_string(name);
+         if (status != json_status::ok) {
+            return status == json_status::unexpected_input ? json_status::invalid_string : status;
+         }
+         status = reader.expect(':');
+         if (status != json_status::ok) {
+            return status;
+         }
+         const auto index = find_member(name);
+         status = index ? member_readers_[*index](reader, *this) : reader.skip_value();
+         if (status != json_status::ok) {
+            return status;
+         }
+         if (!reader.consume(',')) {
+            return reader.expect('}');
+         }
+      }
+   }
+
+   decltype(detail::make_json_record_values<Schema, Index>()) values_
+      = detail::make_json_record_values<Schema, Index>();
+
+private:
+   inline static constexpr auto& children = detail::json_children<Schema, Index>;
+   inline static constexpr std::size_t member_count = children.size() / 2;
+
+   static constexpr std::string_view member_name(std::size_t i) noexcept
+   {
+      const auto& token = detail::json_tokens<Schema>.tokens[children[2 * i]];
+      return {Schema.begin() + token.offset, token.length};
+   }
+
+   // member_count if there's no such member
+   template<string Key>
+   inline static constexpr std::size_t member_index = []() {
+      std::size_t i = 0;
+      while (i != member_count && member_name(i) != std::string_view{Key.begin(), Key.size()}) {
+         ++i;
+      }
+      return i;
+   }();
+
+   inline static constexpr auto member_indexes_ = []() consteval {
+      if constexpr (member_count == 0) {
+         return nil;
+      }
+      else {
+         std::pair<std::string_view, std::size_t> init[member_count];
+         for (std::size_t i = 0; i < member_count; ++i) {
+            init[i] = {member_name(i), i};
+         }
+         return perfect_map<std::string_view, std::size_t, member_count>{init};
+      }
+   }();
+
+   static constexpr std::optional<std::size_t> find_member(std::string_view name) noexcept
+   {
+      if constexpr (member_count == 0) {
+         return std::nullopt;
+      }
+      else {
+         return member_indexes_[name];
+      }
+   }
+
+   template<std::size_t I>
+   static constexpr json_status read_member(detail::json_reader& reader, json_record& record) noexcept
+   {
+      return detail::read_json_schema_value<Schema, children[2 * I + 1]>(reader, record.values_.template get<I>());
+   }
+
+   inline static constexpr auto member_readers_ = []<std::size_t... Is>(std::index_sequence<Is...>) {
+      return std::array<json_status (*)(detail::json_reader&, json_record&), member_count>{&read_member<Is>...};
+   }(std::make_index_sequence<member_count>{});
+};
+
+// What documents shaped like Schema are read into with read_json
+template<string Schema>
+using json_schema_t = detail::json_schema_value_t<Schema, 0>;
+
+// The values of Schema as a json_schema_t; needed to initialize one for schemas that aren't objects
+template<string Schema>
+inline constexpr json_schema_t<Schema> json_schema_defaults = detail::make_json_schema_value<Schema, 0>();
+
+/// @brief Reads a document shaped like Schema into out; see json_record for how values are stored
+///
+/// Reading stops at the first error, leaving what was read so far in out. Errors are reported like json_dom
+/// reports them, with a value of a different type than in the schema being unexpected_input.
+template<string Schema>
+constexpr json_status read_json(std::string_view input, json_schema_t<Schema>& out) noexcept
+{
+   detail::json_reader reader{input};
+   const auto status = detail::read_json_schema_value<Schema, 0>(reader, out);
+   if (status != json_status::ok) {
+      return status;
+   }
+   reader.skip_ws();
+   return reader.pos == input.size() ? json_status::ok : json_status::remaining_input;
+}
+
+namespace detail {
+
+// Appends the text of the value at index to text with each value that isn't constant (everything but objects,
+// arrays, null and the quotes of strings) left out. The position of each left out value is appended to slot_ends
+// and its number is stored in slots[index].
+constexpr void append_json_fragments(
+   std::string_view schema,
+   const json_token* tokens,
+   std::size_t index,
+   std::string& text,
+   std::vector<std::size_t>& slot_ends,
+   std::vector<std::size_t>& slots)
+{
+   const auto& token = tokens[index];
+   if (token.kind == json_kind::object || token.kind == json_kind::array) {
+      const auto is_object = token.kind == json_kind::object;
+      text += is_object ? '{' : '[';
+      for (std::size_t i = 0, child = index + 1; i != token.child_count; ++i) {
+         if (i != 0) {
+            text += ',';
+         }
+         if (is_object) {
+            text += '"';
+            text += schema.substr(tokens[child].offset, tokens[child].length);
+            text += "\":";
+            ++child;
+         }
+         append_json_fragments(schema, tokens, child, text, slot_ends, slots);
+         child = tokens[child].next;
+      }
+      text += is_object ? '}' : ']';
+   }
+   else if (token.kind == json_kind::null) {
+      text += "null";
+   }
+   else {
+      // The quotes of strings are constant as well
+      const auto is_string = token.kind == json_kind::string;
+      if (is_string) {
+         text += '"';
+      }
+      slots[index] = slot_ends.size();
+      slot_ends.push_back(text.size());
+      if (is_string) {
+         text += '"';
+      }
+   }
+}
+
+template<std::size_t TextSize, std::size_t SlotCount, std::size_t TokenCount>
+struct json_fragments {
+   // Fragment i is what comes before value i and fragment SlotCount is what comes after the last value
+   constexpr std::string_view operator[](std::size_t i) const noexcept
+   {
+      const auto begin = i == 0 ? 0 : ends[i - 1];
+      return {text.begin() + begin, ends[i] - begin};
+   }
+
+   string<TextSize + 1> text;
+   std::array<std::size_t, SlotCount + 1> ends;
+   std::array<std::size_t, TokenCount> slots;
+};
+
+// The constant text of documents shaped like Schema as one string, split into the fragments between values
+template<string Schema>
+inline constexpr auto json_schema_fragments = []() {
+   constexpr auto schema = std::string_view{Schema.begin(), Schema.size()};
+   constexpr auto& tokens = json_tokens<Schema>.tokens;
+   constexpr auto sizes = [&]() {
+      std::string text;
+      std::vector<std::size_t> slot_ends;
+      std::vector<std::size_t> slots(tokens.size());
+      append_json_fragments(schema, tokens.data(), 0, text, slot_ends, slots);
+      return std::array{text.size(), slot_ends.size()};
+   }();
+   std::string text;
+   std::vector<std::size_t> slot_ends;
+   std::vector<std::size_t> slots(tokens.size());
+   append_json_fragments(schema, tokens.data(), 0, text, slot_ends, slots);
+   json_fragments<sizes[0], sizes[1], tokens.size()> to_ret{};
+   std::ranges::copy(text, to_ret.text.begin());
+   std::ranges::copy(slot_ends, to_ret.ends.begin());
+   to_ret.ends.back() = text.size();
+   std::ranges::copy(slots, to_ret.slots.begin());
+   return to_ret;
+}();
+
+template<string Schema, std::size_t Index>
+constexpr void write_json_schema_value(buffer_writer& writer, const json_schema_value_t<Schema, Index>& value) noexcept
+{
+   constexpr auto kind = json_tokens<Schema>.tokens[Index].kind;
+   if constexpr (kind == json_kind::object || kind == json_kind::array) {
+      constexpr auto& children = json_children<Schema, Index>;
+      constexpr auto is_object = kind == json_kind::object;
+      const auto& values = [&]() -> const auto& {
+         if constexpr (is_object) {
+            return value.values_;
+         }
+         else {
+            return value;
+         }
+      }();
+      [&]<std::size_t... Is>(std::index_sequence<Is...>) {
+         (write_json_schema_value<Schema, children[is_object ? 2 * Is + 1 : Is]>(writer, values.template get<Is>()),
+          ...);
+      }(std::make_index_sequence<children.size() / (is_object ? 2 : 1)>{});
+   }
+   else if constexpr (kind != json_kind::null) {
+      if constexpr (kind == json_kind::true_ || kind == json_kind::false_) {
+         writer.write(value ? "true" : "false");
+      }
+      else {
+         if constexpr (std::same_as<std::remove_cvref_t<decltype(value)>, double>) {
+            // JSON has no way to write infinities or NaN, which fails the write like running out of room does
+            if (!std::isfinite(value)) {
+               writer.overflowed = true;
+            }
+         }
+         writer.write(value);
+      }
+      constexpr auto& fragments = json_schema_fragments<Schema>;
+      writer.write(fragments[fragments.slots[Index] + 1]);
+   }
+}
+
+} // namespace detail
+
+/// @brief Writes value as minified JSON into buffer, returning the number of characters written or std::nullopt if
+/// it doesn't fit or has a double that's infinite or NaN
+///
+/// Everything but the values (member names, brackets, commas, quotes and nulls) is joined into constant fragments at
+/// compile time, so writing is copying fragments and formatting values. Strings are written as is, so escapes have
+/// to be in them already (as they are in strings read by read_json). Doubles can only be written at runtime.
+template<string Schema>
+constexpr std::optional<std::size_t> write_json(const json_schema_t<Schema>& value, std::span<char> buffer) noexcept
+{
+   detail::buffer_writer writer{buffer.data(), buffer.data() + buffer.size()};
+   writer.write(detail::json_schema_fragments<Schema>[0]);
+   detail::write_json_schema_value<Schema, 0>(writer, value);
+   if (writer.overflowed) {
+      return std::nullopt;
+   }
+   return static_cast<std::size_t>(writer.pos - buffer.data());
+}
+
+} // namespace khct
+
+#endif // KHCT_JSON_SCHEMA_HPP
@@ -2,66 +2,1005 @@
 #define KHCT_MAP_HPP
 
 #include "khct/common.hpp"
+#include "khct/string.hpp"
 
 #include <algorithm>
+#include <array>
+#include <bit>
 #include <compare>
+#include <cstdint>
+#include <functional>
 #include <numeric>
+#include <optional>
 #include <ranges>
+#include <span>
+#include <string_view>
 #include <type_traits>
 #include <utility>
 
+#if defined(__SSE2__) || defined(_M_X64)
+   #include <immintrin.h>
+#endif
+
 namespace khct {
 
-template<typename Key, typename Value, std::size_t Size, typename Comp>
+namespace detail {
+
+constexpr void prefetch([[maybe_unused]] const void* ptr) noexcept
+{
+#if defined(__GNUC__) || defined(__clang__)
+   if (!std::is_constant_evaluated()) {
+      __builtin_prefetch(ptr);
+   }
+#endif
+}
+
+template<typename Comp, typename Key, typename Value, std::size_t Size>
+consteval std::array<std::pair<Key, Value>, Size> sort_by_key(const std::pair<Key, Value> (&init)[Size]) noexcept
+{
+   std::array<std::pair<Key, Value>, Size> to_ret;
+   std::ranges::copy(init, to_ret.begin());
+   std::ranges::sort(to_ret, Comp{}, &std::pair<Key, Value>::first);
+   return to_ret;
+}
+
+// Walks an implicit binary tree stored in breadth first order (1-based, 0 being the end) in sorted order
+template<typename T, std::size_t Size>
+struct eytzinger_iterator {
+   using value_type = std::remove_const_t<T>;
+   using difference_type = std::ptrdiff_t;
+
+   static constexpr std::size_t leftmost(std::size_t index) noexcept
+   {
+      while (2 * index <= Size) {
+         index *= 2;
+      }
+      return index;
+   }
+
+   // The index of the smallest element, which is the end when there are none
+   static constexpr std::size_t first() noexcept { return Size == 0 ? 0 : leftmost(1); }
+
+   constexpr T& operator*() const noexcept { return data_[index_ - 1]; }
+   constexpr T* operator->() const noexcept { return &data_[index_ - 1]; }
+
+   constexpr eytzinger_iterator& operator++() noexcept
+   {
+      if (2 * index_ + 1 <= Size) {
+         index_ = leftmost(2 * index_ + 1);
+      }
+      else {
+         // Go up past every node this was the right child of, then up once more
+         index_ >>= std::countr_one(index_) + 1;
+      }
+      return *this;
+   }
+
+   constexpr eytzinger_iterator operator++(int) noexcept
+   {
+      auto to_ret = *this;
+      ++*this;
+      return to_ret;
+   }
+
+   friend constexpr bool operator==(const eytzinger_iterator& lhs, const eytzinger_iterator& rhs) noexcept
+   {
+      return lhs.index_ == rhs.index_;
+   }
+
+   T* data_ = nullptr;
+   std::size_t index_ = 0;
+};
+
+// Walks parallel key and value arrays, producing pairs of references
+template<typename Key, typename Value>
+struct soa_iterator {
+   // The value type is the same pair of references so this models std::indirectly_readable without a common
+   // reference between std::pair<const Key&, const Value&> and std::pair<Key, Value>
+   using value_type = std::pair<const Key&, const Value&>;
+   using difference_type = std::ptrdiff_t;
+
+   struct arrow_proxy {
+      value_type value;
+      constexpr const value_type* operator->() const noexcept { return &value; }
+   };
+
+   constexpr value_type operator*() const noexcept { return {*key_, *value_}; }
+   constexpr arrow_proxy operator->() const noexcept { return {**this}; }
+
+   constexpr soa_iterator& operator++() noexcept
+   {
+      ++key_;
+      ++value_;
+      return *this;
+   }
+
+   constexpr soa_iterator operator++(int) noexcept
+   {
+      auto to_ret = *this;
+      ++*this;
+      return to_ret;
+   }
+
+   friend constexpr bool operator==(const soa_iterator& lhs, const soa_iterator& rhs) noexcept
+   {
+      return lhs.key_ == rhs.key_;
+   }
+
+   const Key* key_ = nullptr;
+   const Value* value_ = nullptr;
+};
+
+template<typename Key>
+concept simd_key = std::integral<Key> && !std::same_as<Key, bool>
+                && (sizeof(Key) == 1 || sizeof(Key) == 2 || sizeof(Key) == 4 || sizeof(Key) == 8);
+
+// Keys are padded to a multiple of 32 bytes no matter which instruction set is in use so the layout doesn't change
+// between translation units compiled with different flags
+template<simd_key Key, std::size_t Size>
+inline constexpr std::size_t simd_padded_size = (Size * sizeof(Key) + 31) / 32 * 32 / sizeof(Key);
+
+// Returns the index of the first key equal to k or Size if there isn't one
+template<simd_key Key, std::size_t Size>
+constexpr std::size_t simd_find(const std::array<Key, simd_padded_size<Key, Size>>& padded_keys, Key k) noexcept
+{
+   const auto keys = padded_keys.data();
+   if (std::is_constant_evaluated()) {
+      return std::ranges::find(keys, keys + Size, k) - keys;
+   }
+#if defined(__AVX2__)
+   const auto needle = [&]() {
+      if constexpr (sizeof(Key) == 1) {
+         return _mm256_set1_epi8(static_cast<char>(k));
+      }
+      else if constexpr (sizeof(Key) == 2) {
+         return _mm256_set1_epi16(static_cast<short>(k));
+      }
+      else if constexpr (sizeof(Key) == 4) {
+         return _mm256_set1_epi32(static_cast<int>(k));
+      }
+      else {
+         return _mm256_set1_epi64x(static_cast<long long>(k));
+      }
+   }();
+   for (std::size_t i = 0; i < simd_padded_size<Key, Size>; i += 32 / sizeof(Key)) {
+      const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys + i));
+      const auto matches = [&]() {
+         if constexpr (sizeof(Key) == 1) {
+            return _mm256_cmpeq_epi8(block, needle);
+         }
+         else if constexpr (sizeof(Key) == 2) {
+            return _mm256_cmpeq_epi16(block, needle);
+         }
+         else if constexpr (sizeof(Key) == 4) {
+            return _mm256_cmpeq_epi32(block, needle);
+         }
+         else {
+            return _mm256_cmpeq_epi64(block, needle);
+         }
+      }();
+      // Each matching key sets sizeof(Key) bits
+      const auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(matches));
+      if (mask != 0) {
+         return i + std::countr_zero(mask) / sizeof(Key);
+      }
+   }
+   return Size;
+#elif defined(__SSE2__) || defined(_M_X64)
+   const auto needle = [&]() {
+      if constexpr (sizeof(Key) == 1) {
+         return _mm_set1_epi8(static_cast<char>(k));
+      }
+      else if constexpr (sizeof(Key) == 2) {
+         return _mm_set1_epi16(static_cast<short>(k));
+      }
+      else if constexpr (sizeof(Key) == 4) {
+         return _mm_set1_epi32(static_cast<int>(k));
+      }
+      else {
+         return _mm_set1_epi64x(static_cast<long long>(k));
+      }
+   }();
+   for (std::size_t i = 0; i < simd_padded_size<Key, Size>; i += 16 / sizeof(Key)) {
+      const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys + i));
+      const auto matches = [&]() {
+         if constexpr (sizeof(Key) == 1) {
+            return _mm_cmpeq_epi8(block, needle);
+         }
+         else if constexpr (sizeof(Key) == 2) {
+            return _mm_cmpeq_epi16(block, needle);
+         }
+         else if constexpr (sizeof(Key) == 4) {
+            return _mm_cmpeq_epi32(block, needle);
+         }
+         else {
+            // SSE2 has no 64-bit compare; both 32-bit halves of a key have to match
+            const auto halves = _mm_cmpeq_epi32(block, needle);
+            return _mm_and_si128(halves, _mm_shuffle_epi32(halves, _MM_SHUFFLE(2, 3, 0, 1)));
+         }
+      }();
+      const auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(matches));
+      if (mask != 0) {
+         return i + std::countr_zero(mask) / sizeof(Key);
+      }
+   }
+   return Size;
+#else
+   return std::ranges::find(keys, keys + Size, k) - keys;
+#endif
+}
+
+} // namespace detail
+
+// Layouts control how a map stores its values and searches them. Each layout provides a storage template that is
+// constructed from the values sorted by key and provides operator[] and begin/end (iterating in sorted order).
+
+/// @brief Stores the values as one sorted array searched with std::lower_bound
+struct sorted_layout {
+   template<typename Key, typename Value, std::size_t Size, typename Comp>
+   struct storage {
+      constexpr storage() noexcept : values_{} {}
+
+      constexpr explicit storage(std::span<const std::pair<Key, Value>, Size> sorted) noexcept : values_{}
+      {
+         std::ranges::copy(sorted, values_.begin());
+      }
+
+      constexpr std::optional<Value> operator[](const Key& k) const noexcept
+      {
+         const auto loc = std::lower_bound(
+            values_.begin(), values_.end(), k, [](const auto& a, const auto& b) { return Comp{}(a.first, b); });
+         if (loc == values_.end() || Comp{}(k, loc->first)) {
+            return std::nullopt;
+         }
+         return loc->second;
+      }
+
+      constexpr auto begin() const noexcept { return values_.data(); }
+      constexpr auto begin() noexcept { return values_.data(); }
+      constexpr auto end() const noexcept { return values_.data() + Size; }
+      constexpr auto end() noexcept { return values_.data() + Size; }
+
+      // A std::array rather than a built-in array as those can't be empty
+      std::array<std::pair<Key, Value>, Size> values_;
+      friend auto operator<=>(const storage&, const storage&) noexcept = default;
+   };
+};
+
+/// @brief Stores the values in breadth first (Eytzinger) order and searches them with a branchless descent that
+/// prefetches the cache line holding the descendants four levels down; iteration goes through an in-order adapter
+struct eytzinger_layout {
+   template<typename Key, typename Value, std::size_t Size, typename Comp>
+   struct storage {
+      constexpr storage() noexcept : values_{} {}
+
+      constexpr explicit storage(std::span<const std::pair<Key, Value>, Size> sorted) noexcept : values_{}
+      {
+         std::ranges::copy(sorted, begin());
+      }
+
+      constexpr std::optional<Value> operator[](const Key& k) const noexcept
+      {
+         std::size_t index = 1;
+         while (index <= Size) {
+            detail::prefetch(&values_[std::min(index * prefetch_stride, Size) - 1]);
+            index = 2 * index + Comp{}(values_[index - 1].first, k);
+         }
+         // Undo the moves right after the last move left; that node is the lower bound
+         index >>= std::countr_one(index) + 1;
+         if (index == 0 || Comp{}(k, values_[index - 1].first)) {
+            return std::nullopt;
+         }
+         return values_[index - 1].second;
+      }
+
+      constexpr auto begin() const noexcept
+      {
+         using iterator = detail::eytzinger_iterator<const std::pair<Key, Value>, Size>;
+         return iterator{values_.data(), iterator::first()};
+      }
+      constexpr auto begin() noexcept
+      {
+         using iterator = detail::eytzinger_iterator<std::pair<Key, Value>, Size>;
+         return iterator{values_.data(), iterator::first()};
+      }
+      constexpr auto end() const noexcept
+      {
+         return detail::eytzinger_iterator<const std::pair<Key, Value>, Size>{values_.data(), 0};
+      }
+      constexpr auto end() noexcept
+      {
+         return detail::eytzinger_iterator<std::pair<Key, Value>, Size>{values_.data(), 0};
+      }
+
+      std::array<std::pair<Key, Value>, Size> values_;
+      friend auto operator<=>(const storage&, const storage&) noexcept = default;
+
+   private:
+      // Elements per cache line, which are 4 levels down when there are 16 of them
+      inline static constexpr std::size_t prefetch_stride
+         = std::max<std::size_t>(1, std::bit_floor(64 / sizeof(std::pair<Key, Value>)));
+   };
+};
+
+/// @brief Stores the sorted keys and values in separate arrays so a search only touches the keys; the value is only
+/// read on a hit. Iteration produces std::pair<const Key&, const Value&>
+struct soa_layout {
+   template<typename Key, typename Value, std::size_t Size, typename Comp>
+   struct storage {
+      constexpr storage() noexcept : keys_{}, values_{} {}
+
+      constexpr explicit storage(std::span<const std::pair<Key, Value>, Size> sorted) noexcept : keys_{}, values_{}
+      {
+         std::ranges::copy(sorted | std::views::keys, keys_.begin());
+         std::ranges::copy(sorted | std::views::values, values_.begin());
+      }
+
+      constexpr std::optional<Value> operator[](const Key& k) const noexcept
+      {
+         const auto loc = std::lower_bound(keys_.begin(), keys_.end(), k, Comp{});
+         if (loc == keys_.end() || Comp{}(k, *loc)) {
+            return std::nullopt;
+         }
+         return values_[loc - keys_.begin()];
+      }
+
+      constexpr auto begin() const noexcept { return detail::soa_iterator<Key, Value>{keys_.data(), values_.data()}; }
+      constexpr auto end() const noexcept
+      {
+         return detail::soa_iterator<Key, Value>{keys_.data() + Size, values_.data() + Size};
+      }
+
+      std::array<Key, Size> keys_;
+      std::array<Value, Size> values_;
+      friend auto operator<=>(const storage&, const storage&) noexcept = default;
+   };
+};
+
+/// @brief Stores the sorted keys padded to a multiple of 32 bytes apart from the values and finds a key by comparing
+/// a whole vector of keys at once; only usable with integral keys compared with std::less. Iteration produces
+/// std::pair<const Key&, const Value&>
+struct simd_layout {
+   template<detail::simd_key Key, typename Value, std::size_t Size, typename Comp>
+      requires(std::same_as<Comp, std::less<void>> || std::same_as<Comp, std::less<Key>>)
+   struct storage {
+      constexpr storage() noexcept : keys_{}, values_{} {}
+
+      constexpr explicit storage(std::span<const std::pair<Key, Value>, Size> sorted) noexcept : keys_{}, values_{}
+      {
+         std::ranges::copy(sorted | std::views::keys, keys_.begin());
+         std::ranges::copy(sorted | std::views::values, values_.begin());
+         // Pad with the last key; a match on the padding is always preceded by a match on the real key
+         if constexpr (Size != 0) {
+            std::fill(keys_.begin() + Size, keys_.end(), keys_[Size - 1]);
+         }
+      }
+
+      constexpr std::optional<Value> operator[](const Key& k) const noexcept
+      {
+         const auto index = detail::simd_find<Key, Size>(keys_, k);
+         if (index == Size) {
+            return std::nullopt;
+         }
+         return values_[index];
+      }
+
+      constexpr auto begin() const noexcept { return detail::soa_iterator<Key, Value>{keys_.data(), values_.data()}; }
+      constexpr auto end() const noexcept
+      {
+         return detail::soa_iterator<Key, Value>{keys_.data() + Size, values_.data() + Size};
+      }
+
+      alignas(32) std::array<Key, detail::simd_padded_size<Key, Size>> keys_;
+      std::array<Value, Size> values_;
+      friend auto operator<=>(const storage&, const storage&) noexcept = default;
+   };
+};
+
+namespace detail {
+
+// Tags constructors taking elements that are already sorted and have distinct keys
+struct presorted_t {};
+inline constexpr auto presorted = presorted_t{};
+
+} // namespace detail
+
+template<typename Key, typename Value, std::size_t Size, typename Comp, typename Layout = sorted_layout>
    requires(std::is_empty_v<Comp>)
-struct map {
-   consteval map() noexcept : values_{} {}
+struct map : Layout::template storage<Key, Value, Size, Comp> {
+   using layout_storage = Layout::template storage<Key, Value, Size, Comp>;
+   using key_type = Key;
+   using mapped_type = Value;
+   using key_compare = Comp;
+   using layout_type = Layout;
+
+   consteval map() noexcept : layout_storage{} {}
+
+   // A template so that empty maps don't declare a zero-size array parameter
+   template<std::size_t InitSize>
+      requires(InitSize == Size)
+   consteval map(const std::pair<Key, Value> (&init)[InitSize]) noexcept
+      : layout_storage{detail::sort_by_key<Comp>(init)}
+   {}
+
+   consteval map(detail::presorted_t, std::span<const std::pair<Key, Value>, Size> sorted) noexcept
+      : layout_storage{sorted}
+   {}
+
+   constexpr auto size() const noexcept { return Size; }
+
+   friend auto operator<=>(const map&, const map&) noexcept = default;
+};
+
+template<
+   typename Key,
+   typename Value,
+   std::size_t Size,
+   typename Comp = std::less<void>,
+   typename Layout = sorted_layout>
+   requires(std::is_empty_v<Comp>)
+consteval auto make_map(const std::pair<Key, Value> (&init)[Size], Comp = std::less<void>{}, Layout = {}) noexcept
+   -> map<Key, Value, Size, Comp, Layout>
+{
+   return map<Key, Value, Size, Comp, Layout>{init};
+}
+
+/// @brief Distinct keys kept as one sorted array searched with std::lower_bound
+template<typename Key, std::size_t Size, typename Comp = std::less<void>>
+   requires(std::is_empty_v<Comp>)
+struct set {
+   using key_type = Key;
+   using key_compare = Comp;
+
+   consteval set() noexcept : keys_{} {}
+
+   // A template so that empty sets don't declare a zero-size array parameter
+   template<std::size_t InitSize>
+      requires(InitSize == Size)
+   consteval set(const Key (&init)[InitSize]) noexcept : keys_{}
+   {
+      std::ranges::copy(init, keys_.begin());
+      std::ranges::sort(keys_, Comp{});
+      if (std::ranges::adjacent_find(keys_, [](const Key& a, const Key& b) { return !Comp{}(a, b); }) != keys_.end()) {
+         detail::compile_time_error("Duplicate keys would leave the set with the wrong size");
+      }
+   }
+
+   consteval set(detail::presorted_t, std::span<const Key, Size> sorted) noexcept : keys_{}
+   {
+      std::ranges::copy(sorted, keys_.begin());
+   }
+
+   constexpr bool contains(const Key& k) const noexcept
+   {
+      const auto loc = std::lower_bound(keys_.begin(), keys_.end(), k, Comp{});
+      return loc != keys_.end() && !Comp{}(k, *loc);
+   }
+
+   constexpr auto begin() const noexcept { return keys_.begin(); }
+   constexpr auto end() const noexcept { return keys_.end(); }
+   constexpr auto size() const noexcept { return Size; }
+
+   std::array<Key, Size> keys_;
+   friend auto operator<=>(const set&, const set&) noexcept = default;
+};
+
+template<typename Key, std::size_t Size, typename Comp = std::less<void>>
+   requires(std::is_empty_v<Comp>)
+consteval auto make_set(const Key (&init)[Size], Comp = std::less<void>{}) noexcept -> set<Key, Size, Comp>
+{
+   return set<Key, Size, Comp>{init};
+}
+
+// How merge and intersect pick the value for a key in both maps; any other policy is a function called with the
+// left and right values that returns the value to keep
+struct keep_left_t {};
+inline constexpr auto keep_left = keep_left_t{};
+
+struct keep_right_t {};
+inline constexpr auto keep_right = keep_right_t{};
+
+// Makes keys in both maps a compile error
+struct reject_duplicates_t {};
+inline constexpr auto reject_duplicates = reject_duplicates_t{};
 
-   consteval map(const std::pair<Key, Value> (&init)[Size]) noexcept
+namespace detail {
+
+template<typename T>
+inline constexpr bool is_map = false;
+
+template<typename Key, typename Value, std::size_t Size, typename Comp, typename Layout>
+inline constexpr bool is_map<map<Key, Value, Size, Comp, Layout>> = true;
+
+template<typename T>
+inline constexpr bool is_set = false;
+
+template<typename Key, std::size_t Size, typename Comp>
+inline constexpr bool is_set<set<Key, Size, Comp>> = true;
+
+template<const auto& Container>
+using container_t = std::remove_cvref_t<decltype(Container)>;
+
+template<typename Lhs, typename Rhs>
+concept same_key_order = (is_map<Lhs> || is_set<Lhs>) && (is_map<Rhs> || is_set<Rhs>)
+                      && std::same_as<typename Lhs::key_type, typename Rhs::key_type>
+                      && std::same_as<typename Lhs::key_compare, typename Rhs::key_compare>;
+
+template<typename Lhs, typename Rhs>
+concept same_sets = is_set<Lhs> && is_set<Rhs> && same_key_order<Lhs, Rhs>;
+
+template<typename Lhs, typename Rhs>
+concept same_maps = is_map<Lhs> && is_map<Rhs> && same_key_order<Lhs, Rhs>
+                 && std::same_as<typename Lhs::mapped_type, typename Rhs::mapped_type>;
+
+// The map or set like T holding Size elements, which are built from an element_type
+template<typename T, std::size_t Size>
+struct resized;
+
+template<typename Key, typename Value, std::size_t OldSize, typename Comp, typename Layout, std::size_t Size>
+struct resized<map<Key, Value, OldSize, Comp, Layout>, Size> {
+   using type = map<Key, Value, Size, Comp, Layout>;
+   using element_type = std::pair<Key, Value>;
+};
+
+template<typename Key, std::size_t OldSize, typename Comp, std::size_t Size>
+struct resized<set<Key, OldSize, Comp>, Size> {
+   using type = set<Key, Size, Comp>;
+   using element_type = Key;
+};
+
+template<typename T>
+constexpr const auto& key_of(const T& element) noexcept
+{
+   if constexpr (requires { element.first; }) {
+      return element.first;
+   }
+   else {
+      return element;
+   }
+}
+
+// Walks two ranges sorted by Comp in step, calling on_left or on_right with elements whose key is only in that range
+// and on_both with the two elements for a key in both
+template<typename Comp, typename Lhs, typename Rhs, typename OnLeft, typename OnRight, typename OnBoth>
+constexpr void merge_walk(const Lhs& lhs, const Rhs& rhs, OnLeft on_left, OnRight on_right, OnBoth on_both)
+{
+   auto l = lhs.begin();
+   auto r = rhs.begin();
+   while (l != lhs.end() && r != rhs.end()) {
+      if (Comp{}(key_of(*l), key_of(*r))) {
+         on_left(*l);
+         ++l;
+      }
+      else if (Comp{}(key_of(*r), key_of(*l))) {
+         on_right(*r);
+         ++r;
+      }
+      else {
+         on_both(*l, *r);
+         ++l;
+         ++r;
+      }
+   }
+   for (; l != lhs.end(); ++l) {
+      on_left(*l);
+   }
+   for (; r != rhs.end(); ++r) {
+      on_right(*r);
+   }
+}
+
+template<const auto& Lhs, const auto& Rhs>
+consteval std::size_t common_key_count() noexcept
+{
+   std::size_t to_ret = 0;
+   merge_walk<typename container_t<Lhs>::key_compare>(
+      Lhs, Rhs, [](const auto&) {}, [](const auto&) {}, [&](const auto&, const auto&) { ++to_ret; });
+   return to_ret;
+}
+
+// Keeps the elements whose keys are only in Lhs, only in Rhs or in both as asked, all in one pass over each; a key in
+// both keeps resolve(lhs_element, rhs_element). The result is the same kind of container as Lhs
+template<const auto& Lhs, const auto& Rhs, bool KeepLeft, bool KeepRight, bool KeepBoth, typename Resolve>
+consteval auto combine_sorted(Resolve resolve)
+{
+   using lhs_type = container_t<Lhs>;
+   constexpr auto size = [] {
+      const auto common = common_key_count<Lhs, Rhs>();
+      return (KeepLeft ? Lhs.size() - common : 0) + (KeepRight ? Rhs.size() - common : 0) + (KeepBoth ? common : 0);
+   }();
+   static_assert(is_set<lhs_type> || size != 0, "The result would be an empty map, which the map layouts can't hold");
+   std::array<typename resized<lhs_type, size>::element_type, size> elements{};
+   std::size_t count = 0;
+   merge_walk<typename lhs_type::key_compare>(
+      Lhs,
+      Rhs,
+      [&](const auto& l) {
+         if constexpr (KeepLeft) {
+            elements[count++] = l;
+         }
+      },
+      [&](const auto& r) {
+         if constexpr (KeepRight) {
+            elements[count++] = r;
+         }
+      },
+      [&](const auto& l, const auto& r) {
+         if constexpr (KeepBoth) {
+            elements[count++] = resolve(l, r);
+         }
+      });
+   return typename resized<lhs_type, size>::type{presorted, elements};
+}
+
+template<typename Policy>
+constexpr auto conflict_resolver(const Policy& policy) noexcept
+{
+   return [&](const auto& l, const auto& r) {
+      if constexpr (std::same_as<Policy, keep_left_t>) {
+         return l;
+      }
+      else if constexpr (std::same_as<Policy, keep_right_t>) {
+         return r;
+      }
+      else {
+         using element = std::pair<std::remove_cvref_t<decltype(l.first)>, std::remove_cvref_t<decltype(l.second)>>;
+         return element{l.first, policy(l.second, r.second)};
+      }
+   };
+}
+
+template<typename Policy, typename Map>
+concept conflict_policy = std::same_as<Policy, keep_left_t> || std::same_as<Policy, keep_right_t>
+                       || std::same_as<Policy, reject_duplicates_t>
+                       || std::convertible_to<
+                             std::invoke_result_t<Policy&, const typename Map::mapped_type&,
+                                                  const typename Map::mapped_type&>,
+                             typename Map::mapped_type>;
+
+} // namespace detail
+
+/// @brief Merges two maps with the same key, value and comparison types in a single pass over their sorted elements
+///
+/// The result has room for every element of both, so keys in both maps are an error; merge<Lhs, Rhs>(policy) can keep
+/// one of them instead
+template<typename Key, typename Value, std::size_t Size1, std::size_t Size2, typename Comp, typename Layout>
+consteval auto
+   merge(const map<Key, Value, Size1, Comp, Layout>& lhs, const map<Key, Value, Size2, Comp, Layout>& rhs)
+      -> map<Key, Value, Size1 + Size2, Comp, Layout>
+{
+   std::array<std::pair<Key, Value>, Size1 + Size2> values;
+   std::size_t count = 0;
+   const auto keep = [&](const auto& element) { values[count++] = element; };
+   detail::merge_walk<Comp>(lhs, rhs, keep, keep, [](const auto&, const auto&) {
+      detail::compile_time_error("A key is in both maps");
+   });
+   return map<Key, Value, Size1 + Size2, Comp, Layout>{detail::presorted, values};
+}
+
+/// @brief Merges the maps or sets Lhs and Rhs (references to constexpr variables) in one pass over each
+///
+/// For maps, policy decides the value of a key in both: keep_left, keep_right, reject_duplicates (a compile error) or a
+/// function combining the two values. The result is sized to the number of distinct keys and has Lhs's layout
+template<const auto& Lhs, const auto& Rhs, typename Policy = reject_duplicates_t>
+   requires(
+      (detail::same_maps<detail::container_t<Lhs>, detail::container_t<Rhs>>
+       && detail::conflict_policy<Policy, detail::container_t<Lhs>>)
+      || (detail::same_sets<detail::container_t<Lhs>, detail::container_t<Rhs>>
+          && std::same_as<Policy, reject_duplicates_t>))
+consteval auto merge(Policy policy = {})
+{
+   if constexpr (detail::is_set<detail::container_t<Lhs>>) {
+      return detail::combine_sorted<Lhs, Rhs, true, true, true>(detail::conflict_resolver(keep_left));
+   }
+   else {
+      if constexpr (std::same_as<Policy, reject_duplicates_t>) {
+         static_assert(detail::common_key_count<Lhs, Rhs>() == 0,
+                       "The merged maps have keys in common; pass a policy to pick between their values");
+         return detail::combine_sorted<Lhs, Rhs, true, true, false>(detail::conflict_resolver(keep_left));
+      }
+      else {
+         return detail::combine_sorted<Lhs, Rhs, true, true, true>(detail::conflict_resolver(policy));
+      }
+   }
+}
+
+/// @brief The elements of the map or set Lhs whose keys are also in the map or set Rhs, found in one pass over each
+///
+/// When both are maps, policy can keep the value from Rhs or combine the two values instead
+template<const auto& Lhs, const auto& Rhs, typename Policy = keep_left_t>
+   requires(
+      (detail::same_key_order<detail::container_t<Lhs>, detail::container_t<Rhs>> && std::same_as<Policy, keep_left_t>)
+      || (detail::same_maps<detail::container_t<Lhs>, detail::container_t<Rhs>>
+          && detail::conflict_policy<Policy, detail::container_t<Lhs>> && !std::same_as<Policy, reject_duplicates_t>))
+consteval auto intersect(Policy policy = {})
+{
+   return detail::combine_sorted<Lhs, Rhs, false, false, true>(detail::conflict_resolver(policy));
+}
+
+/// @brief The elements of the map or set Lhs whose keys aren't in the map or set Rhs, found in one pass over each
+template<const auto& Lhs, const auto& Rhs>
+   requires(detail::same_key_order<detail::container_t<Lhs>, detail::container_t<Rhs>>)
+consteval auto difference()
+{
+   return detail::combine_sorted<Lhs, Rhs, true, false, false>(detail::conflict_resolver(keep_left));
+}
+
+namespace detail {
+
+// splitmix64 finalizer
+constexpr std::uint64_t mix64(std::uint64_t x) noexcept
+{
+   x ^= x >> 30;
+   x *= 0xbf58476d1ce4e5b9;
+   x ^= x >> 27;
+   x *= 0x94d049bb133111eb;
+   x ^= x >> 31;
+   return x;
+}
+
+} // namespace detail
+
+/// @brief Seeded hash used by perfect_map; handles integral and enum keys as well as ranges of integral values
+/// (e.g., khct::string and std::string_view)
+struct default_hash {
+   template<typename T>
+      requires(std::integral<T> || std::is_enum_v<T>)
+   constexpr std::uint64_t operator()(const T& val, std::uint64_t seed) const noexcept
+   {
+      return detail::mix64(static_cast<std::uint64_t>(val) ^ detail::mix64(seed));
+   }
+
+   template<std::ranges::input_range Range>
+      requires(std::integral<std::ranges::range_value_t<Range>>)
+   constexpr std::uint64_t operator()(const Range& range, std::uint64_t seed) const noexcept
+   {
+      std::uint64_t to_ret = detail::mix64(seed);
+      for (const auto c : range) {
+         to_ret = (to_ret ^ static_cast<std::uint64_t>(c)) * 0x100000001b3;
+      }
+      return detail::mix64(to_ret);
+   }
+};
+
+// Hash and displace: every key is hashed once, the upper half of the hash picks a bucket and the displacement
+// stored for that bucket is mixed into the hash to pick the slot. The displacements are chosen at construction
+// so that no two keys share a slot, so a lookup is one hash, one probe and one key compare.
+template<
+   typename Key,
+   typename Value,
+   std::size_t Size,
+   typename Hash = default_hash,
+   typename Eq = std::equal_to<void>>
+   requires(std::is_empty_v<Hash> && std::is_empty_v<Eq>)
+struct perfect_map {
+   inline static constexpr std::size_t bucket_count = Size / 2 + 1;
+
+   consteval perfect_map() noexcept : seed_{}, displacements_{}, values_{} {}
+
+   // A template so that empty maps don't declare a zero-size array parameter
+   template<std::size_t InitSize>
+      requires(InitSize == Size)
+   consteval perfect_map(const std::pair<Key, Value> (&init)[InitSize]) noexcept : seed_{}, displacements_{}, values_{}
    {
-      std::ranges::copy(init, std::begin(values_));
-      std::ranges::sort(values_, Comp{});
+      std::array<std::uint64_t, Size> hashes;
+      std::array<std::size_t, Size> order;
+      std::array<std::size_t, Size> slots;
+      std::array<bool, Size> taken;
+      for (std::uint64_t seed = 0;; ++seed) {
+         if (seed == max_seeds) {
+            detail::compile_time_error("Keys no seed can separate are almost certainly a hash collision");
+         }
+         for (std::size_t i = 0; i < Size; ++i) {
+            hashes[i] = Hash{}(init[i].first, seed);
+         }
+         // Group the keys by bucket with the largest buckets first so they're placed while most of the table is
+         // still free; a counting sort is used as a comparison sort is slow during constant evaluation
+         std::array<std::size_t, bucket_count> bucket_starts{};
+         for (const auto hash : hashes) {
+            ++bucket_starts[bucket_index(hash)];
+         }
+         const auto largest_bucket = *std::ranges::max_element(bucket_starts);
+         std::size_t next_start = 0;
+         for (auto bucket_size = largest_bucket; bucket_size != 0; --bucket_size) {
+            for (auto& start : bucket_starts) {
+               if (start == bucket_size) {
+                  // Offset by Size so this bucket isn't seen again in later iterations
+                  start = next_start + Size;
+                  next_start += bucket_size;
+               }
+            }
+         }
+         for (std::size_t i = 0; i < Size; ++i) {
+            order[bucket_starts[bucket_index(hashes[i])]++ - Size] = i;
+         }
+         std::ranges::fill(taken, false);
+         bool success = true;
+         for (std::size_t first = 0; success && first != Size;) {
+            const auto bucket = bucket_index(hashes[order[first]]);
+            auto last = first + 1;
+            while (last != Size && bucket_index(hashes[order[last]]) == bucket) {
+               ++last;
+            }
+            for (auto i = first; i != last; ++i) {
+               for (auto j = first; j != i; ++j) {
+                  if (Eq{}(init[order[i]].first, init[order[j]].first)) {
+                     detail::compile_time_error("Duplicate keys can never be given separate slots");
+                  }
+               }
+            }
+            success = false;
+            for (std::uint32_t disp = 0; !success && disp < max_displacement; ++disp) {
+               success = true;
+               for (auto i = first; success && i != last; ++i) {
+                  slots[i] = slot_index(hashes[order[i]], disp);
+                  success = !taken[slots[i]] && std::find(&slots[first], &slots[i], slots[i]) == &slots[i];
+               }
+               if (success) {
+                  for (auto i = first; i != last; ++i) {
+                     taken[slots[i]] = true;
+                  }
+                  displacements_[bucket] = disp;
+               }
+            }
+            first = last;
+         }
+         if (success) {
+            seed_ = seed;
+            for (std::size_t i = 0; i < Size; ++i) {
+               values_[slots[i]] = init[order[i]];
+            }
+            return;
+         }
+      }
    }
 
    constexpr std::optional<Value> operator[](const Key& k) const noexcept
    {
-      const auto loc = std::lower_bound(
-         std::begin(values_), std::end(values_), k, [](const auto& a, const auto& b) { return Comp{}(a.first, b); });
-      if (loc == std::end(values_)) {
+      // There are no slots to hash into
+      if constexpr (Size == 0) {
          return std::nullopt;
       }
-      return loc->second;
+      else {
+         const auto hash = Hash{}(k, seed_);
+         const auto& loc = values_[slot_index(hash, displacements_[bucket_index(hash)])];
+         if (!Eq{}(loc.first, k)) {
+            return std::nullopt;
+         }
+         return loc.second;
+      }
    }
 
-   constexpr auto begin() const noexcept { return values_; }
-   constexpr auto begin() noexcept { return values_; }
-   constexpr auto end() const noexcept { return &values_[Size]; }
-   constexpr auto end() noexcept { return &values_[Size]; }
-   constexpr auto size() noexcept { return Size; }
+   // Iteration is in slot order; use map when ordered iteration is needed
+   constexpr auto begin() const noexcept { return values_.data(); }
+   constexpr auto end() const noexcept { return values_.data() + Size; }
+   constexpr auto size() const noexcept { return Size; }
 
-   std::pair<Key, Value> values_[Size];
-   friend auto operator<=>(const map&, const map&) noexcept = default;
+   std::uint64_t seed_;
+   std::uint32_t displacements_[bucket_count];
+   std::array<std::pair<Key, Value>, Size> values_;
+   friend auto operator<=>(const perfect_map&, const perfect_map&) noexcept = default;
+
+private:
+   inline static constexpr std::uint64_t max_seeds = 64;
+   inline static constexpr std::uint32_t max_displacement = 1 << 16;
+
+   static constexpr std::size_t bucket_index(std::uint64_t hash) noexcept { return (hash >> 32) % bucket_count; }
+
+   static constexpr std::size_t slot_index(std::uint64_t hash, std::uint32_t displacement) noexcept
+   {
+      return detail::mix64(hash ^ displacement) % Size;
+   }
 };
 
-template<typename Key, typename Value, std::size_t Size1, std::size_t Size2, typename Comp>
-consteval auto merge(const map<Key, Value, Size1, Comp>& lhs, const map<Key, Value, Size2, Comp>& rhs)
-   -> map<Key, Value, Size1 + Size2, Comp>
+template<
+   typename Key,
+   typename Value,
+   std::size_t Size,
+   typename Hash = default_hash,
+   typename Eq = std::equal_to<void>>
+   requires(std::is_empty_v<Hash> && std::is_empty_v<Eq>)
+consteval auto make_perfect_map(const std::pair<Key, Value> (&init)[Size], Hash = {}, Eq = {}) noexcept
+   -> perfect_map<Key, Value, Size, Hash, Eq>
 {
-   map<Key, Value, Size1 + Size2, Comp> to_ret;
-   std::ranges::copy(lhs, to_ret.begin());
-   std::ranges::copy(rhs, to_ret.begin() + Size1);
-   std::ranges::sort(to_ret, Comp{});
-   return to_ret;
+   return perfect_map<Key, Value, Size, Hash, Eq>{init};
 }
 
-template<typename Key, typename Value, std::size_t Size, typename Comp = std::less<void>>
-   requires(std::is_empty_v<Comp>)
-consteval auto make_map(const std::pair<Key, Value> (&init)[Size], Comp = std::less<void>{}) noexcept
-   -> map<Key, Value, Size, Comp>
+template<typename Key, typename Value, std::size_t Size, typename Comp, typename Layout>
+consteval auto make_perfect_map(const map<Key, Value, Size, Comp, Layout>& from) noexcept
+   -> perfect_map<Key, Value, Size>
+{
+   if constexpr (Size == 0) {
+      return {};
+   }
+   else {
+      std::pair<Key, Value> values[Size];
+      std::ranges::copy(from, values);
+      return perfect_map<Key, Value, Size>{values};
+   }
+}
+
+namespace detail {
+
+template<typename Key>
+struct runtime_key {
+   using type = Key;
+   static constexpr const Key& from(const Key& key) noexcept { return key; }
+};
+
+// Keys of different lengths are padded with trailing spaces to a common size (see string::operator string<NewSize>)
+// so trailing spaces are ignored when looking up string keys at runtime
+template<std::size_t Size>
+struct runtime_key<string<Size>> {
+   using type = std::string_view;
+   static constexpr std::string_view from(std::string_view key) noexcept
+   {
+      return key.substr(0, key.find_last_not_of(' ') + 1);
+   }
+   static constexpr std::string_view from(const string<Size>& key) noexcept
+   {
+      return from(std::string_view{key.begin(), key.size()});
+   }
+};
+
+template<typename Key>
+using runtime_key_t = runtime_key<Key>::type;
+
+// Maps integral keys spanning a small range to their indexes with a single table load
+template<typename Key, std::size_t Size, std::size_t Range>
+struct dense_index_map {
+   constexpr std::optional<std::size_t> operator[](const Key& k) const noexcept
+   {
+      const auto offset = static_cast<std::uint64_t>(k) - static_cast<std::uint64_t>(min_);
+      if (offset >= Range || indexes_[offset] == Size) {
+         return std::nullopt;
+      }
+      return indexes_[offset];
+   }
+
+   Key min_;
+   std::size_t indexes_[Range];
+};
+
+template<typename Key, std::size_t Size, std::array<Key, Size> Keys>
+consteval auto make_perfect_index_map() noexcept
 {
-   return map<Key, Value, Size, Comp>{init};
+   std::pair<runtime_key_t<Key>, std::size_t> init[Size];
+   for (std::size_t i = 0; i < Size; ++i) {
+      init[i] = {runtime_key<Key>::from(Keys[i]), i};
+   }
+   return perfect_map<runtime_key_t<Key>, std::size_t, Size>{init};
 }
 
+template<typename Key, std::size_t Size, std::array<Key, Size> Keys>
+consteval auto make_index_map() noexcept
+{
+   if constexpr (Size == 0) {
+      return nil;
+   }
+   else if constexpr (std::integral<Key>) {
+      constexpr auto min_max = std::ranges::minmax(Keys);
+      // Compared before adding one, which wraps to zero for keys spanning the whole 64 bit range
+      constexpr auto span = static_cast<std::uint64_t>(min_max.max) - static_cast<std::uint64_t>(min_max.min);
+      if constexpr (span < 2 * Size) {
+         dense_index_map<Key, Size, span + 1> to_ret{min_max.min, {}};
+         std::ranges::fill(to_ret.indexes_, Size);
+         for (std::size_t i = 0; i < Size; ++i) {
+            to_ret.indexes_[static_cast<std::uint64_t>(Keys[i]) - static_cast<std::uint64_t>(min_max.min)] = i;
+         }
+         return to_ret;
+      }
+      else {
+         return make_perfect_index_map<Key, Size, Keys>();
+      }
+   }
+   else {
+      return make_perfect_index_map<Key, Size, Keys>();
+   }
+}
+
+} // namespace detail
+
 template<
    typename Key,
    typename Comp,
@@ -80,12 +1019,66 @@ struct multi_type_map {
          return nil;
       }
       else {
-         constexpr auto index = std::distance(std::begin(Keys), loc);
-         return std::get<Mapping[index]>(std::tuple{Values...});
+         return values_.template get<std::distance(std::begin(Keys), loc)>();
+      }
+   }
+
+   /// @brief Gets the value of the key at index I in sorted key order
+   template<std::size_t I>
+   static constexpr const auto& get_at() noexcept
+   {
+      return values_.template get<I>();
+   }
+
+   // Calls visitor with the value for key, or with nil if there is no such key. The key is turned into an index with
+   // a dense table for integral keys covering a small range and with a perfect hash otherwise, which then indexes a
+   // table of functions that each call visitor with one value; as with std::visit, the results need a common type.
+   template<typename Visitor>
+   constexpr decltype(auto) visit(const detail::runtime_key_t<Key>& key, Visitor&& visitor) const
+   {
+      using result = decltype(visit_result<Visitor>(std::make_index_sequence<Size>{}));
+
+      if constexpr (Size == 0) {
+         return static_cast<result>(visitor(nil));
+      }
+      else {
+         const auto index = index_map[detail::runtime_key<Key>::from(key)];
+         return dispatch_table<result, Visitor>[index.value_or(Size)](visitor);
       }
    }
 
    friend auto operator<=>(const multi_type_map&, const multi_type_map&) noexcept = default;
+
+private:
+   // Every value in sorted key order, built once per map so that each lookup is a single indexed tuple access
+   inline static constexpr auto values_ = []<std::size_t... Is>(std::index_sequence<Is...>) {
+      constexpr tuple<std::remove_cvref_t<decltype(Values)>...> in_order_given{Values...};
+      return tuple<std::remove_cvref_t<decltype(in_order_given.template get<Mapping[Is]>())>...>{
+         in_order_given.template get<Mapping[Is]>()...};
+   }(std::make_index_sequence<Size>{});
+
+   inline static constexpr auto index_map = detail::make_index_map<Key, Size, Keys>();
+
+   template<typename Visitor, std::size_t... Is>
+   static auto visit_result(std::index_sequence<Is...>) -> std::common_type_t<
+      std::invoke_result_t<Visitor&, decltype(get_at<Is>())>...,
+      std::invoke_result_t<Visitor&, const nil_t&>>;
+
+   template<std::size_t I, typename Result, typename Visitor>
+   static constexpr Result visit_index(Visitor& visitor)
+   {
+      if constexpr (I == Size) {
+         return visitor(nil);
+      }
+      else {
+         return visitor(get_at<I>());
+      }
+   }
+
+   template<typename Result, typename Visitor>
+   inline static constexpr auto dispatch_table = []<std::size_t... Is>(std::index_sequence<Is...>) {
+      return std::array<Result (*)(Visitor&), Size + 1>{&visit_index<Is, Result, Visitor>...};
+   }(std::make_index_sequence<Size + 1>{});
 };
 
 template<pair... Pairs, typename Comp = std::less<void>>
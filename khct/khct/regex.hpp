@@ -0,0 +1,797 @@
+#ifndef KHCT_REGEX_HPP
+#define KHCT_REGEX_HPP
+
+#include <khct/string.hpp>
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <limits>
+#include <optional>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace khct {
+
+namespace detail {
+
+struct byte_set {
+   constexpr void add(unsigned char c) noexcept { bits[c / 64] |= std::uint64_t{1} << (c % 64); }
+
+   constexpr void add(unsigned char first, unsigned char last) noexcept
+   {
+      for (unsigned c = first; c <= last; ++c) {
+         add(static_cast<unsigned char>(c));
+      }
+   }
+
+   constexpr void add(const byte_set& other) noexcept
+   {
+      for (std::size_t i = 0; i < bits.size(); ++i) {
+         bits[i] |= other.bits[i];
+      }
+   }
+
+   constexpr void invert() noexcept
+   {
+      for (auto& word : bits) {
+         word = ~word;
+      }
+   }
+
+   constexpr bool contains(unsigned char c) const noexcept { return (bits[c / 64] >> (c % 64)) & 1; }
+
+   // The byte in the set if it has exactly one
+   constexpr std::optional<unsigned char> single() const noexcept
+   {
+      int count = 0;
+      std::size_t word = 0;
+      for (std::size_t i = 0; i < bits.size(); ++i) {
+         count += std::popcount(bits[i]);
+         word = bits[i] != 0 ? i : word;
+      }
+      if (count != 1) {
+         return std::nullopt;
+      }
+      return static_cast<unsigned char>(word * 64 + std::countr_zero(bits[word]));
+   }
+
+   std::array<std::uint64_t, 4> bits{};
+};
+
+enum class regex_node_kind { bytes, empty, concat, alternate, repeat };
+
+inline constexpr std::size_t regex_unbounded = std::numeric_limits<std::size_t>::max();
+
+// Bounded repetitions are expanded into copies of what they repeat, so they're capped to keep the automaton small
+inline constexpr std::size_t regex_max_repeat = 1000;
+
+struct regex_node {
+   regex_node_kind kind;
+   byte_set bytes{};
+   std::size_t left = 0;
+   std::size_t right = 0;
+   std::size_t min = 0;
+   std::size_t max = 0;
+};
+
+// Recursive descent over the pattern into a syntax tree; each function returns the index of the node it parsed or
+// std::nullopt if the pattern is invalid
+struct regex_parser {
+   constexpr std::optional<std::size_t> parse()
+   {
+      const auto to_ret = alternation();
+      if (pos != pattern.size()) {
+         return std::nullopt;
+      }
+      return to_ret;
+   }
+
+   constexpr std::size_t add(const regex_node& node)
+   {
+      nodes.push_back(node);
+      return nodes.size() - 1;
+   }
+
+   constexpr std::optional<std::size_t> alternation()
+   {
+      auto to_ret = concatenation();
+      while (to_ret && pos < pattern.size() && pattern[pos] == '|') {
+         ++pos;
+         const auto right = concatenation();
+         if (!right) {
+            return std::nullopt;
+         }
+         to_ret = add({.kind = regex_node_kind::alternate, .left = *to_ret, .right = *right});
+      }
+      return to_ret;
+   }
+
+   constexpr std::optional<std::size_t> concatenation()
+   {
+      std::optional<std::size_t> to_ret;
+      while (pos < pattern.size() && pattern[pos] != '|' && pattern[pos] != ')') {
+         const auto next = repetition();
+         if (!next) {
+            return std::nullopt;
+         }
+         to_ret = to_ret ? add({.kind = regex_node_kind::concat, .left = *to_ret, .right = *next}) : *next;
+      }
+      return to_ret ? to_ret : add({.kind = regex_node_kind::empty});
+   }
+
+   constexpr std::optional<std::size_t> repetition()
+   {
+      auto to_ret = atom();
+      while (to_ret && pos < pattern.size()) {
+         std::size_t min = 0;
+         std::size_t max = regex_unbounded;
+         if (pattern[pos] == '+') {
+            min = 1;
+         }
+         else if (pattern[pos] == '?') {
+            max = 1;
+         }
+         else if (pattern[pos] == '{') {
+            if (!bounds(min, max)) {
+               return std::nullopt;
+            }
+            --pos;
+         }
+         else if (pattern[pos] != '*') {
+            break;
+         }
+         ++pos;
+         to_ret = add({.kind = regex_node_kind::repeat, .left = *to_ret, .min = min, .max = max});
+      }
+      return to_ret;
+   }
+
+   // Parses {n}, {n,} or {n,m} leaving pos on the closing brace
+   constexpr bool bounds(std::size_t& min, std::size_t& max)
+   {
+      ++pos;
+      const auto first = number();
+      if (!first) {
+         return false;
+      }
+      min = *first;
+      max = *first;
+      if (pos < pattern.size() && pattern[pos] == ',') {
+         ++pos;
+         const auto second = number();
+         max = second ? *second : regex_unbounded;
+      }
+      if (pos >= pattern.size() || pattern[pos] != '}' || min > max || min > regex_max_repeat
+          || (max != regex_unbounded && max > regex_max_repeat)) {
+         return false;
+      }
+      ++pos;
+      return true;
+   }
+
+   constexpr std::optional<std::size_t> number()
+   {
+      std::optional<std::size_t> to_ret;
+      while (pos < pattern.size() && pattern[pos] >= '0' && pattern[pos] <= '9') {
+         to_ret = to_ret.value_or(0) * 10 + static_cast<std::size_t>(pattern[pos++] - '0');
+         if (*to_ret > regex_max_repeat) {
+            return std::nullopt;
+         }
+      }
+      return to_ret;
+   }
+
+   constexpr std::optional<std::size_t> atom()
+   {
+      const auto c = pattern[pos++];
+      byte_set bytes;
+      if (c == '(') {
+         if (pattern.substr(pos).starts_with("?:")) {
+            pos += 2;
+         }
+         const auto to_ret = alternation();
+         if (!to_ret || pos >= pattern.size() || pattern[pos] != ')') {
+            return std::nullopt;
+         }
+         ++pos;
+         return to_ret;
+      }
+      else if (c == '[') {
+         if (!bracket(bytes)) {
+            return std::nullopt;
+         }
+      }
+      else if (c == '.') {
+         bytes.add('\n');
+         bytes.invert();
+      }
+      else if (c == '\\') {
+         if (!escape(bytes)) {
+            return std::nullopt;
+         }
+      }
+      else if (std::string_view{"*+?{}]^$"}.find(c) != std::string_view::npos) {
+         // Quantifiers with nothing to repeat, unmatched brackets and anchors, which aren't supported
+         return std::nullopt;
+      }
+      else {
+         bytes.add(static_cast<unsigned char>(c));
+      }
+      return add({.kind = regex_node_kind::bytes, .bytes = bytes});
+   }
+
+   // Parses the escape after a backslash
+   constexpr bool escape(byte_set& bytes)
+   {
+      if (pos >= pattern.size()) {
+         return false;
+      }
+      const auto c = pattern[pos++];
+      const auto lower = static_cast<char>(c | 0x20);
+      if (lower == 'd') {
+         bytes.add('0', '9');
+      }
+      else if (lower == 'w') {
+         bytes.add('a', 'z');
+         bytes.add('A', 'Z');
+         bytes.add('0', '9');
+         bytes.add('_');
+      }
+      else if (lower == 's') {
+         for (const auto space : std::string_view{" \t\n\r\f\v"}) {
+            bytes.add(static_cast<unsigned char>(space));
+         }
+      }
+      else if (c == 'x') {
+         const auto hex_digit = [](char d) {
+            return d >= '0' && d <= '9' ? d - '0' : (d | 0x20) >= 'a' && (d | 0x20) <= 'f' ? (d | 0x20) - 'a' + 10 : -1;
+         };
+         if (pos + 2 > pattern.size() || hex_digit(pattern[pos]) < 0 || hex_digit(pattern[pos + 1]) < 0) {
+            return false;
+         }
+         bytes.add(static_cast<unsigned char>(hex_digit(pattern[pos]) * 16 + hex_digit(pattern[pos + 1])));
+         pos += 2;
+      }
+      else {
+         constexpr std::string_view letters = "ntrfv0";
+         constexpr std::string_view values = "\n\t\r\f\v";
+         const auto letter = letters.find(c);
+         if (letter != std::string_view::npos) {
+            bytes.add(static_cast<unsigned char>(letter < values.size() ? values[letter] : '\0'));
+            return true;
+         }
+         // Other letters and digits are reserved; any other character stands for itself
+         const auto is_alnum = (lower >= 'a' && lower <= 'z') || (c >= '0' && c <= '9');
+         if (is_alnum) {
+            return false;
+         }
+         bytes.add(static_cast<unsigned char>(c));
+         return true;
+      }
+      if (c != lower) {
+         bytes.invert();
+      }
+      return true;
+   }
+
+   // Parses the rest of a [] class after the opening bracket
+   constexpr bool bracket(byte_set& bytes)
+   {
+      const auto negate = pos < pattern.size() && pattern[pos] == '^';
+      pos += negate;
+      for (bool first = true; pos >= pattern.size() || pattern[pos] != ']' || first; first = false) {
+         byte_set item;
+         if (!bracket_item(item)) {
+            return false;
+         }
+         const auto low = item.single();
+         if (low && pos + 1 < pattern.size() && pattern[pos] == '-' && pattern[pos + 1] != ']') {
+            ++pos;
+            byte_set high_item;
+            if (!bracket_item(high_item)) {
+               return false;
+            }
+            const auto high = high_item.single();
+            if (!high || *high < *low) {
+               return false;
+            }
+            bytes.add(*low, *high);
+         }
+         else {
+            bytes.add(item);
+         }
+      }
+      ++pos;
+      if (negate) {
+         bytes.invert();
+      }
+      return true;
+   }
+
+   constexpr bool bracket_item(byte_set& bytes)
+   {
+      if (pos >= pattern.size()) {
+         return false;
+      }
+      if (pattern[pos] == '\\') {
+         ++pos;
+         return escape(bytes);
+      }
+      bytes.add(static_cast<unsigned char>(pattern[pos++]));
+      return true;
+   }
+
+   std::string_view pattern;
+   std::size_t pos = 0;
+   std::vector<regex_node> nodes{};
+};
+
+inline constexpr std::size_t regex_no_state = std::numeric_limits<std::size_t>::max();
+
+// Consumes a byte in bytes to go to out, or otherwise goes to out and out2 (when set) without consuming anything
+struct nfa_state {
+   byte_set bytes{};
+   bool consumes = false;
+   std::size_t out = regex_no_state;
+   std::size_t out2 = regex_no_state;
+};
+
+// Every fragment ends in a state with no transitions yet to link it to whatever follows
+struct nfa_fragment {
+   std::size_t start;
+   std::size_t end;
+};
+
+// Thompson's construction
+struct nfa_builder {
+   constexpr std::size_t add(const nfa_state& state)
+   {
+      states.push_back(state);
+      return states.size() - 1;
+   }
+
+   constexpr nfa_fragment build(std::size_t index)
+   {
+      const auto node = nodes[index];
+      if (node.kind == regex_node_kind::bytes) {
+         const auto end = add({});
+         return {add({.bytes = node.bytes, .consumes = true, .out = end}), end};
+      }
+      else if (node.kind == regex_node_kind::empty) {
+         const auto end = add({});
+         return {end, end};
+      }
+      else if (node.kind == regex_node_kind::concat) {
+         const auto left = build(node.left);
+         const auto right = build(node.right);
+         states[left.end].out = right.start;
+         return {left.start, right.end};
+      }
+      else if (node.kind == regex_node_kind::alternate) {
+         const auto left = build(node.left);
+         const auto right = build(node.right);
+         const auto end = add({});
+         states[left.end].out = end;
+         states[right.end].out = end;
+         return {add({.out = left.start, .out2 = right.start}), end};
+      }
+      else {
+         auto to_ret = build(regex_node{.kind = regex_node_kind::empty});
+         const auto append = [&](nfa_fragment next) {
+            states[to_ret.end].out = next.start;
+            to_ret.end = next.end;
+         };
+         for (std::size_t i = 0; i < node.min; ++i) {
+            append(build(node.left));
+         }
+         const auto optional_copies = node.max == regex_unbounded ? 1 : node.max - node.min;
+         for (std::size_t i = 0; i < optional_copies; ++i) {
+            const auto repeated = build(node.left);
+            const auto end = add({});
+            const auto skip = add({.out = repeated.start, .out2 = end});
+            states[repeated.end].out = node.max == regex_unbounded ? skip : end;
+            append({skip, end});
+         }
+         return to_ret;
+      }
+   }
+
+   // Builds the node without it being in nodes
+   constexpr nfa_fragment build(const regex_node& node)
+   {
+      nodes.push_back(node);
+      return build(nodes.size() - 1);
+   }
+
+   std::vector<regex_node> nodes;
+   std::vector<nfa_state> states{};
+};
+
+// Points every transition the other way and adds a start state that loops on every byte, giving an automaton that
+// reads the input backwards and accepts after reading the byte at any position a match starts at
+constexpr void reverse_unanchored(std::vector<nfa_state>& states, std::size_t& start, std::size_t& end)
+{
+   const auto count = states.size();
+   // State s of the result stands for state s of the original, without consuming anything
+   std::vector<nfa_state> reversed(count);
+   std::vector<std::vector<std::size_t>> targets(count);
+   for (std::size_t s = 0; s < count; ++s) {
+      if (states[s].consumes) {
+         reversed.push_back({.bytes = states[s].bytes, .consumes = true, .out = s});
+         targets[states[s].out].push_back(reversed.size() - 1);
+      }
+      else {
+         for (const auto out : {states[s].out, states[s].out2}) {
+            if (out != regex_no_state) {
+               targets[out].push_back(s);
+            }
+         }
+      }
+   }
+   // States with more than two targets reach the rest through a chain of added states
+   for (std::size_t s = 0; s < count; ++s) {
+      auto at = s;
+      for (std::size_t i = 0; i < targets[s].size(); ++i) {
+         if (i == 0) {
+            reversed[at].out = targets[s][i];
+         }
+         else if (i + 1 == targets[s].size()) {
+            reversed[at].out2 = targets[s][i];
+         }
+         else {
+            reversed.push_back({.out = targets[s][i]});
+            reversed[at].out2 = reversed.size() - 1;
+            at = reversed.size() - 1;
+         }
+      }
+   }
+   byte_set any;
+   any.invert();
+   reversed.push_back({.out2 = end});
+   const auto loop = reversed.size() - 1;
+   reversed.push_back({.bytes = any, .consumes = true, .out = loop});
+   reversed[loop].out = reversed.size() - 1;
+   end = start;
+   start = loop;
+   states = reversed;
+}
+
+// The minimal DFA for a pattern; state 0 is the dead state that nothing leaves and the input bytes are grouped into
+// classes of bytes that no transition tells apart
+struct compiled_regex {
+   std::array<std::uint8_t, 256> byte_classes{};
+   std::size_t class_count = 0;
+   std::vector<std::size_t> transitions{};
+   std::vector<std::uint8_t> accepting{};
+   std::size_t start = 0;
+};
+
+constexpr std::size_t add_byte_classes(const std::vector<nfa_state>& states, std::array<std::uint8_t, 256>& classes)
+{
+   std::size_t count = 1;
+   for (const auto& state : states) {
+      if (!state.consumes) {
+         continue;
+      }
+      // Split every class into the bytes in the set and the ones that aren't
+      std::vector<std::size_t> renumbered(count * 2, regex_no_state);
+      std::size_t new_count = 0;
+      for (std::size_t c = 0; c < classes.size(); ++c) {
+         auto& to = renumbered[classes[c] * 2 + state.bytes.contains(static_cast<unsigned char>(c))];
+         to = to == regex_no_state ? new_count++ : to;
+         classes[c] = static_cast<std::uint8_t>(to);
+      }
+      count = new_count;
+   }
+   return count;
+}
+
+// Subset construction followed by Moore's partition refinement; with reverse the DFA is for reverse_unanchored's
+// automaton
+constexpr bool compile_regex(std::string_view pattern, compiled_regex& out, bool reverse = false)
+{
+   regex_parser parser{pattern};
+   const auto root = parser.parse();
+   if (!root) {
+      return false;
+   }
+   nfa_builder nfa{parser.nodes};
+   auto fragment = nfa.build(*root);
+   auto& states = nfa.states;
+   if (reverse) {
+      reverse_unanchored(states, fragment.start, fragment.end);
+   }
+   out.class_count = add_byte_classes(states, out.byte_classes);
+
+   std::vector<unsigned char> representatives(out.class_count);
+   for (std::size_t c = 256; c-- > 0;) {
+      representatives[out.byte_classes[c]] = static_cast<unsigned char>(c);
+   }
+
+   using state_set = std::vector<std::uint64_t>;
+   const auto add_closure = [&](state_set& set, std::size_t first) {
+      std::vector<std::size_t> to_visit{first};
+      while (!to_visit.empty()) {
+         const auto index = to_visit.back();
+         to_visit.pop_back();
+         if (index == regex_no_state || (set[index / 64] >> (index % 64)) & 1) {
+            continue;
+         }
+         set[index / 64] |= std::uint64_t{1} << (index % 64);
+         if (!states[index].consumes) {
+            to_visit.push_back(states[index].out);
+            to_visit.push_back(states[index].out2);
+         }
+      }
+   };
+
+   const auto words = (states.size() + 63) / 64;
+   std::vector<state_set> subsets{state_set(words)};
+   const auto find_or_add = [&](const state_set& set) {
+      for (std::size_t i = 0; i < subsets.size(); ++i) {
+         if (subsets[i] == set) {
+            return i;
+         }
+      }
+      subsets.push_back(set);
+      return subsets.size() - 1;
+   };
+   auto start = state_set(words);
+   add_closure(start, fragment.start);
+   const auto dfa_start = find_or_add(start);
+
+   std::vector<std::size_t> transitions;
+   std::vector<std::size_t> blocks;
+   for (std::size_t i = 0; i < subsets.size(); ++i) {
+      const auto subset = subsets[i];
+      for (const auto byte : representatives) {
+         auto next = state_set(words);
+         for (std::size_t s = 0; s < states.size(); ++s) {
+            if ((subset[s / 64] >> (s % 64)) & 1 && states[s].consumes && states[s].bytes.contains(byte)) {
+               add_closure(next, states[s].out);
+            }
+         }
+         transitions.push_back(find_or_add(next));
+      }
+      blocks.push_back((subset[fragment.end / 64] >> (fragment.end % 64)) & 1);
+   }
+
+   // Split blocks of states until the states in each block agree on which block every class goes to. Blocks are
+   // numbered in order of their first state, so the dead state stays state 0
+   std::size_t block_count = 0;
+   while (true) {
+      std::vector<std::vector<std::size_t>> signatures;
+      std::vector<std::size_t> new_blocks;
+      for (std::size_t s = 0; s < subsets.size(); ++s) {
+         std::vector<std::size_t> signature{blocks[s]};
+         for (std::size_t c = 0; c < out.class_count; ++c) {
+            signature.push_back(blocks[transitions[s * out.class_count + c]]);
+         }
+         const auto found = std::ranges::find(signatures, signature);
+         new_blocks.push_back(static_cast<std::size_t>(found - signatures.begin()));
+         if (found == signatures.end()) {
+            signatures.push_back(signature);
+         }
+      }
+      blocks = new_blocks;
+      if (signatures.size() == block_count) {
+         break;
+      }
+      block_count = signatures.size();
+   }
+
+   out.transitions.resize(block_count * out.class_count);
+   out.accepting.resize(block_count);
+   for (std::size_t s = 0; s < subsets.size(); ++s) {
+      for (std::size_t c = 0; c < out.class_count; ++c) {
+         out.transitions[blocks[s] * out.class_count + c] = blocks[transitions[s * out.class_count + c]];
+      }
+      out.accepting[blocks[s]] = (subsets[s][fragment.end / 64] >> (fragment.end % 64)) & 1;
+   }
+   out.start = blocks[dfa_start];
+   return true;
+}
+
+template<typename State, std::size_t StateCount, std::size_t ClassCount>
+struct regex_dfa {
+   inline static constexpr State dead = 0;
+
+   constexpr State next(State state, char c) const noexcept
+   {
+      return transitions[state * ClassCount + byte_classes[static_cast<unsigned char>(c)]];
+   }
+
+   std::array<std::uint8_t, 256> byte_classes;
+   std::array<State, StateCount * ClassCount> transitions;
+   std::array<bool, StateCount> accepting;
+   State start;
+   bool valid;
+};
+
+template<string Pattern, bool Reverse = false>
+inline constexpr auto regex_tables = []() {
+   constexpr auto pattern = std::string_view{Pattern.begin(), Pattern.size()};
+   constexpr auto sizes = [&]() {
+      compiled_regex compiled;
+      if (!compile_regex(pattern, compiled, Reverse)) {
+         return std::array<std::size_t, 2>{1, 1};
+      }
+      return std::array{compiled.accepting.size(), compiled.class_count};
+   }();
+   // The smallest type for the state numbers keeps more of the table in cache
+   using state_type = std::conditional_t<
+      (sizes[0] <= 256),
+      std::uint8_t,
+      std::conditional_t<(sizes[0] <= 65536), std::uint16_t, std::uint32_t>>;
+   regex_dfa<state_type, sizes[0], sizes[1]> to_ret{};
+   compiled_regex compiled;
+   to_ret.valid = compile_regex(pattern, compiled, Reverse);
+   if (to_ret.valid) {
+      to_ret.byte_classes = compiled.byte_classes;
+      std::ranges::transform(
+         compiled.transitions, to_ret.transitions.begin(), [](std::size_t s) { return static_cast<state_type>(s); });
+      std::ranges::copy(compiled.accepting, to_ret.accepting.begin());
+      to_ret.start = static_cast<state_type>(compiled.start);
+   }
+   return to_ret;
+}();
+
+} // namespace detail
+
+/// @brief A regular expression compiled at compile time into a minimal DFA, which matches at runtime or during constant
+/// evaluation without allocating
+///
+/// Supports literals, ., [] classes with ranges and ^, the escapes \d \w \s \D \W \S \n \r \t \f \v \0 and \xHH,
+/// escaped punctuation, grouping with () or (?:), | and the quantifiers *, +, ?, {n}, {n,} and {n,m}. Matching is on
+/// bytes and finds the leftmost longest match like POSIX rather than the leftmost first like ECMAScript. There are no
+/// anchors, captures or backreferences; match checks the whole input instead.
+///
+/// match and search take time linear in the length of the input, as does finding each match of find_all in the rest
+/// of the input.
+template<string Pattern>
+struct regex {
+   static_assert(detail::regex_tables<Pattern>.valid, "Invalid or unsupported regular expression");
+
+   class match_iterator {
+   public:
+      using value_type = std::string_view;
+      using difference_type = std::ptrdiff_t;
+
+      match_iterator() = default;
+
+      constexpr std::string_view operator*() const noexcept { return *current_; }
+
+      constexpr match_iterator& operator++() noexcept
+      {
+         // Step past empty matches so they aren't found again
+         const auto end = static_cast<std::size_t>(current_->data() - input_.data()) + current_->size();
+         current_ = search_from(input_, current_->empty() ? end + 1 : end);
+         return *this;
+      }
+
+      constexpr match_iterator operator++(int) noexcept
+      {
+         auto to_ret = *this;
+         ++*this;
+         return to_ret;
+      }
+
+      friend constexpr bool operator==(const match_iterator& it, std::default_sentinel_t) noexcept
+      {
+         return !it.current_;
+      }
+
+   private:
+      friend regex;
+
+      constexpr match_iterator(std::string_view input) noexcept : input_{input}, current_{search_from(input, 0)} {}
+
+      std::string_view input_;
+      std::optional<std::string_view> current_;
+   };
+
+   struct match_range {
+      constexpr match_iterator begin() const noexcept { return match_iterator{input}; }
+      constexpr std::default_sentinel_t end() const noexcept { return {}; }
+
+      std::string_view input;
+   };
+
+   /// @brief Whether all of input matches
+   static constexpr bool match(std::string_view input) noexcept
+   {
+      constexpr auto& dfa = detail::regex_tables<Pattern>;
+      auto state = dfa.start;
+      for (const auto c : input) {
+         state = dfa.next(state, c);
+         if (state == dfa.dead) {
+            return false;
+         }
+      }
+      return dfa.accepting[state];
+   }
+
+   template<detail::string_like String>
+   static constexpr bool match(const String& str) noexcept
+   {
+      return match(std::string_view{str.begin(), str.size()});
+   }
+
+   /// @brief The leftmost longest match in input
+   static constexpr std::optional<std::string_view> search(std::string_view input) noexcept
+   {
+      return search_from(input, 0);
+   }
+
+   /// @brief Every match in input from left to right, without overlaps; each is found as the range is iterated
+   static constexpr match_range find_all(std::string_view input) noexcept { return {input}; }
+
+private:
+   // The end of the longest match starting at first; scanned is how many bytes were read to find it
+   static constexpr std::optional<std::size_t>
+      longest_match(std::string_view input, std::size_t first, std::size_t& scanned) noexcept
+   {
+      constexpr auto& dfa = detail::regex_tables<Pattern>;
+      auto state = dfa.start;
+      auto to_ret = dfa.accepting[state] ? std::optional{first} : std::nullopt;
+      auto i = first;
+      while (i < input.size()) {
+         state = dfa.next(state, input[i++]);
+         if (state == dfa.dead) {
+            break;
+         }
+         if (dfa.accepting[state]) {
+            to_ret = i;
+         }
+      }
+      scanned = i - first;
+      return to_ret;
+   }
+
+   // The leftmost position from first on that a match starts at, found in one backward pass over the input
+   static constexpr std::optional<std::size_t> leftmost_start(std::string_view input, std::size_t first) noexcept
+   {
+      constexpr auto& dfa = detail::regex_tables<Pattern, true>;
+      auto state = dfa.start;
+      auto to_ret = dfa.accepting[state] ? std::optional{input.size()} : std::nullopt;
+      for (auto i = input.size(); i-- > first;) {
+         state = dfa.next(state, input[i]);
+         if (dfa.accepting[state]) {
+            to_ret = i;
+         }
+      }
+      return to_ret;
+   }
+
+   static constexpr std::optional<std::string_view> search_from(std::string_view input, std::size_t first) noexcept
+   {
+      // Trying each start in turn finds a nearby match quickly, but text that keeps beginning a match without
+      // completing one would be scanned again from every start. Once that has read as many bytes as are left, the
+      // leftmost start is found with a backward pass instead, so a search never reads more than a few times the input
+      std::size_t budget = first <= input.size() ? input.size() - first : 0;
+      for (auto i = first; i <= input.size(); ++i) {
+         std::size_t scanned = 0;
+         if (const auto end = longest_match(input, i, scanned)) {
+            return input.substr(i, *end - i);
+         }
+         if (scanned >= budget && i < input.size()) {
+            const auto start = leftmost_start(input, i + 1);
+            if (!start) {
+               return std::nullopt;
+            }
+            return input.substr(*start, *longest_match(input, *start, scanned) - *start);
+         }
+         budget -= scanned;
+      }
+      return std::nullopt;
+   }
+};
+
+} // namespace khct
+
+#endif // KHCT_REGEX_HPP
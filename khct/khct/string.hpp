@@ -8,6 +8,7 @@
 #include <ranges>
 #include <string_view>
 #include <tuple>
+#include <type_traits>
 
 namespace khct {
 
@@ -81,65 +82,188 @@ consteval auto operator+(const string<SizeL>& lhs, const string<SizeR>& rhs) noe
    return to_ret;
 }
 
+/// @brief Refers to the characters [Begin, End) of the string template parameter Str without copying them
+///
+/// Splicing a string_ref gives another string_ref into the same Str, so taking pieces of a long string doesn't create
+/// a new string type and copy for every piece; to_string() materializes the characters when a string is needed
+template<string Str, std::size_t Begin = 0, std::size_t End = Str.size()>
+   requires(Begin <= End && End <= Str.size())
+struct string_ref {
+   template<std::size_t Start, std::size_t Stop>
+   consteval string_ref<Str, Begin + Start, Begin + Stop> splice() const noexcept
+   {
+      static_assert(Stop >= Start);
+      static_assert(Stop <= End - Begin);
+      return {};
+   }
+
+   consteval string<End - Begin + 1> to_string() const noexcept { return Str.template splice<Begin, End>(); }
+
+   template<std::size_t Padsize, char Filler = ' '>
+   consteval auto pad_left() const noexcept
+   {
+      return to_string().template pad_left<Padsize, Filler>();
+   }
+
+   template<std::size_t Padsize, char Filler = ' '>
+   consteval auto pad_right() const noexcept
+   {
+      return to_string().template pad_right<Padsize, Filler>();
+   }
+
+   template<std::size_t NewSize>
+      requires(NewSize >= End - Begin + 1)
+   consteval operator string<NewSize>() const noexcept
+   {
+      return to_string();
+   }
+
+   constexpr operator std::string_view() const noexcept { return {begin(), end()}; }
+
+   constexpr auto begin() const noexcept { return Str.begin() + Begin; }
+   constexpr auto end() const noexcept { return Str.begin() + End; }
+   constexpr auto size() const noexcept { return End - Begin; }
+   constexpr auto empty() const noexcept { return size() == 0; }
+
+   constexpr char operator[](std::size_t index) const noexcept { return Str[Begin + index]; }
+
+   friend constexpr bool operator==(const string_ref& lhs, std::string_view rhs) noexcept
+   {
+      return std::string_view{lhs} == rhs;
+   }
+
+   template<std::size_t Size>
+   friend constexpr bool operator==(const string_ref& lhs, const string<Size>& rhs) noexcept
+   {
+      return std::string_view{lhs} == std::string_view{rhs.begin(), rhs.size()};
+   }
+};
+
+template<string Str1, std::size_t Begin1, std::size_t End1, string Str2, std::size_t Begin2, std::size_t End2>
+constexpr bool
+   operator==(const string_ref<Str1, Begin1, End1>& lhs, const string_ref<Str2, Begin2, End2>& rhs) noexcept
+{
+   return std::string_view{lhs} == std::string_view{rhs};
+}
+
 namespace detail {
 
-template<string Str, char SplitChar, std::size_t MaxSplits>
-consteval auto split_helper() noexcept
+template<typename T>
+inline constexpr bool is_string_ref = false;
+
+template<string Str, std::size_t Begin, std::size_t End>
+inline constexpr bool is_string_ref<string_ref<Str, Begin, End>> = true;
+
+template<string Str, std::size_t Begin, std::size_t End, char SplitChar, std::size_t MaxSplits>
+consteval std::size_t split_count() noexcept
 {
-   constexpr auto split_loc = std::ranges::find(Str, SplitChar);
-   if constexpr (split_loc == std::end(Str)) {
-      return std::make_tuple(Str);
-   }
-   else {
-      constexpr auto split_index = std::distance(std::begin(Str), split_loc);
-      constexpr auto split = Str.template splice<0, split_index>();
-      constexpr auto rest = Str.template splice<split_index + 1, Str.size()>();
-      if constexpr (MaxSplits == 1) {
-         return std::make_tuple(split, rest);
-      }
-      else {
-         constexpr auto next_split_num = MaxSplits == 0 ? 0 : MaxSplits - 1;
-         return std::tuple_cat(std::make_tuple(split), split_helper<rest, SplitChar, next_split_num>());
-      }
+   const auto separators = static_cast<std::size_t>(std::count(Str.begin() + Begin, Str.begin() + End, SplitChar));
+   return (MaxSplits == 0 ? separators : std::min(separators, MaxSplits)) + 1;
+}
+
+template<string Str, std::size_t Begin, std::size_t End, char SplitChar, std::size_t Count>
+consteval auto find_split_pieces() noexcept
+{
+   std::array<std::string_view, Count> to_ret;
+   auto piece_begin = Str.begin() + Begin;
+   for (std::size_t i = 0; i + 1 < Count; ++i) {
+      const auto piece_end = std::find(piece_begin, Str.begin() + End, SplitChar);
+      to_ret[i] = {piece_begin, piece_end};
+      piece_begin = piece_end + 1;
    }
+   to_ret[Count - 1] = {piece_begin, Str.begin() + End};
+   return to_ret;
+}
+
+template<string Str, std::size_t Begin, std::size_t End>
+consteval auto strip_leading_whitespace_helper() noexcept
+{
+   // TODO: Maybe create a one_of class so this is cleaner (e.g., c == one_of{' ', '\f', ...})
+   constexpr auto is_ws
+      = [](char c) { return c == ' ' || c == '\f' || c == '\n' || c == '\r' || c == '\t' || c == '\v'; };
+   constexpr std::size_t non_ws_index = std::find_if_not(Str.begin() + Begin, Str.begin() + End, is_ws) - Str.begin();
+   return string_ref<Str, non_ws_index, End>{};
 }
 
 } // namespace detail
 
+/// @brief The pieces of [Begin, End) of Str split on SplitChar, splitting at most MaxSplits times unless it's 0
+///
+/// Every piece is found in a single pass and kept as a view of Str, so the number of pieces doesn't affect the
+/// number of instantiations. The pieces are std::string_views when indexed or iterated (also at runtime) and
+/// string_refs when accessed with get; split_result can be used with structured bindings.
+template<string Str, std::size_t Begin, std::size_t End, char SplitChar, std::size_t MaxSplits>
+struct split_result {
+   inline static constexpr std::size_t count = detail::split_count<Str, Begin, End, SplitChar, MaxSplits>();
+
+   constexpr std::string_view operator[](std::size_t index) const noexcept { return pieces_[index]; }
+
+   template<std::size_t I>
+   constexpr auto get() const noexcept
+   {
+      constexpr std::size_t offset = pieces_[I].data() - Str.begin();
+      return string_ref<Str, offset, offset + pieces_[I].size()>{};
+   }
+
+   constexpr auto begin() const noexcept { return pieces_.begin(); }
+   constexpr auto end() const noexcept { return pieces_.end(); }
+   constexpr auto size() const noexcept { return count; }
+
+private:
+   inline static constexpr auto pieces_ = detail::find_split_pieces<Str, Begin, End, SplitChar, count>();
+};
+
 template<string Str, char SplitChar, std::size_t MaxSplits = 0>
 consteval auto split() noexcept
 {
-   return detail::split_helper<Str, SplitChar, MaxSplits>();
+   return split_result<Str, 0, Str.size(), SplitChar, MaxSplits>{};
+}
+
+template<auto Ref, char SplitChar, std::size_t MaxSplits = 0>
+   requires(detail::is_string_ref<std::remove_cvref_t<decltype(Ref)>>)
+consteval auto split() noexcept
+{
+   return []<string Str, std::size_t Begin, std::size_t End>(string_ref<Str, Begin, End>) {
+      return split_result<Str, Begin, End, SplitChar, MaxSplits>{};
+   }(Ref);
 }
 
 template<string Str>
 consteval auto strip_leading_whitespace() noexcept
 {
-   // TODO: Maybe create a one_of class so this is cleaner (e.g., c == one_of{' ', '\f', ...})
-   constexpr auto is_ws
-      = [](char c) { return c == ' ' || c == '\f' || c == '\n' || c == '\r' || c == '\t' || c == '\v'; };
-   constexpr auto non_ws_loc = std::ranges::find_if_not(Str, is_ws);
-   if constexpr (non_ws_loc == std::end(Str)) {
-      return string{""};
-   }
-   else {
-      constexpr auto splice_loc = std::distance(std::begin(Str), non_ws_loc);
-      return Str.template splice<splice_loc, Str.size()>();
-   }
+   return detail::strip_leading_whitespace_helper<Str, 0, Str.size()>();
+}
+
+template<auto Ref>
+   requires(detail::is_string_ref<std::remove_cvref_t<decltype(Ref)>>)
+consteval auto strip_leading_whitespace() noexcept
+{
+   return []<string Str, std::size_t Begin, std::size_t End>(string_ref<Str, Begin, End>) {
+      return detail::strip_leading_whitespace_helper<Str, Begin, End>();
+   }(Ref);
 }
 
 namespace detail {
 
+template<typename T>
+inline constexpr bool is_string = false;
+
+template<std::size_t Size>
+inline constexpr bool is_string<string<Size>> = true;
+
+template<typename T>
+concept string_like = is_string<T> || is_string_ref<T>;
+
 template<std::size_t Start, std::size_t End>
 struct splice_struct {
-   template<std::size_t Size>
-   consteval auto operator()(const string<Size>& str) const noexcept
+   template<string_like String>
+   consteval auto operator()(const String& str) const noexcept
    {
       return str.template splice<Start, End>();
    }
 
-   template<std::size_t Size>
-   friend consteval auto operator|(const string<Size>& str, splice_struct) noexcept
+   template<string_like String>
+   friend consteval auto operator|(const String& str, splice_struct) noexcept
    {
       return str.template splice<Start, End>();
    }
@@ -147,14 +271,14 @@ struct splice_struct {
 
 template<std::size_t Padsize, char Filler = ' '>
 struct pad_left_struct {
-   template<std::size_t Size>
-   consteval auto operator()(const string<Size>& str) const noexcept
+   template<string_like String>
+   consteval auto operator()(const String& str) const noexcept
    {
       return str.template pad_left<Padsize, Filler>();
    }
 
-   template<std::size_t Size>
-   friend consteval auto operator|(const string<Size>& str, pad_left_struct) noexcept
+   template<string_like String>
+   friend consteval auto operator|(const String& str, pad_left_struct) noexcept
    {
       return str.template pad_left<Padsize, Filler>();
    }
@@ -162,14 +286,14 @@ struct pad_left_struct {
 
 template<std::size_t Padsize, char Filler = ' '>
 struct pad_right_struct {
-   template<std::size_t Size>
-   consteval auto operator()(const string<Size>& str) const noexcept
+   template<string_like String>
+   consteval auto operator()(const String& str) const noexcept
    {
       return str.template pad_right<Padsize, Filler>();
    }
 
-   template<std::size_t Size>
-   friend consteval auto operator|(const string<Size>& str, pad_right_struct) noexcept
+   template<string_like String>
+   friend consteval auto operator|(const String& str, pad_right_struct) noexcept
    {
       return str.template pad_right<Padsize, Filler>();
    }
@@ -188,4 +312,13 @@ inline constexpr auto pad_right = detail::pad_right_struct<Padsize, Filler>{};
 
 } // namespace khct
 
+template<khct::string Str, std::size_t Begin, std::size_t End, char SplitChar, std::size_t MaxSplits>
+struct std::tuple_size<khct::split_result<Str, Begin, End, SplitChar, MaxSplits>>
+   : std::integral_constant<std::size_t, khct::split_result<Str, Begin, End, SplitChar, MaxSplits>::count> {};
+
+template<std::size_t I, khct::string Str, std::size_t Begin, std::size_t End, char SplitChar, std::size_t MaxSplits>
+struct std::tuple_element<I, khct::split_result<Str, Begin, End, SplitChar, MaxSplits>> {
+   using type = decltype(khct::split_result<Str, Begin, End, SplitChar, MaxSplits>{}.template get<I>());
+};
+
 #endif // KHCT_STRING_HPP
@@ -1,5 +1,10 @@
 #include "khct/common.hpp"
 
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <utility>
+
 using namespace khct;
 
 constexpr auto test_tuple = tuple<int, double>{1, 2.0};
@@ -8,17 +13,52 @@ static_assert(test_tuple.get<1>() == 2.0);
 constexpr auto tuple2 = tuple<double, int>{4.0, 4};
 static_assert(tuple_cat(test_tuple, tuple2) == tuple{1, 2.0, 4.0, 4});
 
+// Element access doesn't recurse through the elements, so it works with hundreds of them
+constexpr auto large_tuple = []<std::size_t... Is>(std::index_sequence<Is...>) {
+   return tuple{std::integral_constant<std::size_t, Is>{}...};
+}(std::make_index_sequence<1000>{});
+static_assert(large_tuple.get<0>() == 0);
+static_assert(large_tuple.get<999>() == 999);
+static_assert(
+   std::same_as<std::remove_cvref_t<decltype(large_tuple.get<999>())>, std::integral_constant<std::size_t, 999>>);
+
+struct move_only {
+   constexpr move_only(int val) : val{val} {}
+   constexpr move_only(move_only&& other) : val{other.val} { other.val = -1; }
+   move_only(const move_only&) = delete;
+
+   int val;
+};
+
+static_assert([]() {
+   auto moved_from = tuple<move_only, int>{move_only{1}, 2};
+   const auto joined = tuple_cat(std::move(moved_from), tuple{3.0}, tuple<move_only>{{4}});
+   return joined.get<0>().val == 1 && moved_from.get<0>().val == -1 && joined.get<1>() == 2 && joined.get<2>() == 3.0
+       && joined.get<3>().val == 4;
+}());
+static_assert(std::same_as<decltype(tuple<move_only>{{1}}.get<0>()), move_only&&>);
+static_assert(std::same_as<decltype(tuple_cat()), tuple<>>);
+
+bool check_runtime_moves()
+{
+   auto source = tuple<std::unique_ptr<int>, std::string>{std::make_unique<int>(5), std::string(64, 'a')};
+   const auto data = source.get<1>().data();
+   const auto joined = tuple_cat(tuple{1}, std::move(source));
+   return *joined.get<1>() == 5 && !source.get<0>() && joined.get<2>().data() == data;
+}
+
 int main()
 {
-   // struct move_only_int {
-   //    move_only_int(int val) : val{val} {}
-   //    move_only_int(const move_only_int&) = delete;
-   //    move_only_int(move_only_int&&) = default;
-   //    move_only_int& operator=(const move_only_int&) = delete;
-   //    move_only_int& operator=(move_only_int&&) = default;
-
-   //    int val;
-   // };
-   // tuple<move_only_int> move_only_test{{10}};
-   // [[maybe_unused]] int second = std::move(move_only_test.get<0>()).val;
+   struct move_only_int {
+      move_only_int(int val) : val{val} {}
+      move_only_int(const move_only_int&) = delete;
+      move_only_int(move_only_int&&) = default;
+      move_only_int& operator=(const move_only_int&) = delete;
+      move_only_int& operator=(move_only_int&&) = default;
+
+      int val;
+   };
+   tuple<move_only_int> move_only_test{{10}};
+   [[maybe_unused]] int second = std::move(move_only_test.get<0>()).val;
+   return check_runtime_moves() ? 0 : 1;
 }
@@ -0,0 +1,55 @@
+#include "khct/format.hpp"
+
+#include <limits>
+#include <string>
+#include <vector>
+
+using namespace khct;
+
+template<string Fmt, typename... Args>
+constexpr bool formats_to(std::string_view expected, const Args&... args)
+{
+   char buffer[64]{};
+   const auto size = format<Fmt>(buffer, args...);
+   return size ? std::string_view{buffer, *size} == expected : expected == "<overflow>";
+}
+
+static_assert(formats_to<"req {} took {}us">("req 42 took -7us", 42u, -7));
+static_assert(formats_to<"no arguments">("no arguments"));
+static_assert(formats_to<"">(""));
+static_assert(formats_to<"{}{}{}">("atruefalse", 'a', true, false));
+static_assert(formats_to<"[{}]">("[view]", std::string_view{"view"}));
+static_assert(formats_to<"[{}]">("[literal]", "literal"));
+static_assert(formats_to<"[{}|{}]">("[padded|spliced]", string{"padded"}, string_ref<"a spliced string", 2, 9>{}));
+static_assert(formats_to<"{{{}}}">("{0}", 0));
+static_assert(formats_to<"{}">("-9223372036854775808", std::numeric_limits<std::int64_t>::min()));
+static_assert(formats_to<"{}">("18446744073709551615", std::numeric_limits<std::uint64_t>::max()));
+static_assert(formats_to<"{} and more text than fits in the buffer, which is only sixty-four">("<overflow>", 1));
+
+// The format string is parsed once into the literal pieces between arguments
+static_assert(formatter<"a{}b{{c{}">::argument_count == 2);
+static_assert(detail::format_string_pieces<"a{}b{{c{}">[0] == "a");
+static_assert(detail::format_string_pieces<"a{}b{{c{}">[1] == "b{c");
+static_assert(detail::format_string_pieces<"a{}b{{c{}">[2] == "");
+
+// Bad format strings, argument counts and argument types don't compile
+static_assert(!detail::format_string_pieces<"{">.valid);
+static_assert(!detail::format_string_pieces<"}">.valid);
+static_assert(!detail::format_string_pieces<"{0}">.valid);
+static_assert(!std::invocable<formatter<"{}">, std::span<char>>);
+static_assert(!std::invocable<formatter<"{}">, std::span<char>, int, int>);
+static_assert(!std::invocable<formatter<"{}">, std::span<char>, std::vector<int>>);
+static_assert(!std::invocable<formatter<"{}">, std::span<char>, int*>);
+
+bool check_runtime_format()
+{
+   volatile double opaque = 0.25;
+   const std::string name = "lookup";
+   char buffer[64];
+   const auto size = format<"{} {} took {}us ({}%)">(buffer, name, 17ull, opaque, 1.5f);
+   char small[4];
+   return size && std::string_view{buffer, *size} == "lookup 17 took 0.25us (1.5%)"
+       && !format<"{}">(small, name);
+}
+
+int main() { return check_runtime_format() ? 0 : 1; }
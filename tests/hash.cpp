@@ -0,0 +1,54 @@
+#include "khct/hash.hpp"
+
+#include <string>
+
+using namespace khct;
+
+static_assert(fnv1a("") == 0xcbf29ce484222325);
+static_assert(fnv1a("a") == 0xaf63dc4c8601ec8c);
+static_assert(fnv1a("foobar") == 0x85944171f73967e8);
+static_assert(fnv1a(string{"foobar"}) == fnv1a("foobar"));
+static_assert(fnv1a(string_ref<"xfoobarx", 1, 7>{}) == fnv1a("foobar"));
+
+// Values from the reference implementation, covering the stripe, 8, 4 and 1 byte paths
+static_assert(xxhash64("") == 0xef46db3751d8e999);
+static_assert(xxhash64("a") == 0xd24ec4f1a98c6e5b);
+static_assert(xxhash64("abc") == 0x44bc2cf5ad770999);
+static_assert(xxhash64(string{"abc"}) == xxhash64("abc"));
+static_assert(xxhash64("abc", 1) == 0xbea9ca8199328908);
+static_assert(xxhash64("stopped", 7) == 0x30f67e70fbdea7fd);
+static_assert(xxhash64("0123456789abcdef0123456789abcdef0123456789abcde") == 0xceb8c23313303cfc);
+
+using commands = string_switch<"start", "stop", "status", "restart", "">;
+static_assert(commands::index_of("start") == 0);
+static_assert(commands::index_of("status") == 2);
+static_assert(commands::index_of("") == 4);
+static_assert(commands::index_of("sta") == commands::no_match);
+static_assert(commands::index_of("starts") == commands::no_match);
+static_assert(commands::case_index<"restart"> == 3);
+static_assert(string_switch<"only">::index_of("only") == 0);
+static_assert(string_switch<"only">::index_of("other") == 1);
+
+int run_command(std::string_view command)
+{
+   switch (commands::index_of(command)) {
+   case commands::case_index<"start">:
+      return 1;
+   case commands::case_index<"stop">:
+      return 2;
+   case commands::no_match:
+      return -1;
+   default:
+      return 0;
+   }
+}
+
+bool check_runtime_switch()
+{
+   const std::string stop = "stop";
+   std::string stopped = stop + "ped";
+   return run_command(stop) == 2 && run_command("start") == 1 && run_command("status") == 0
+       && run_command(stopped) == -1 && xxhash64(stopped) == xxhash64("stopped");
+}
+
+int main() { return check_runtime_switch() ? 0 : 1; }
@@ -1,18 +1,56 @@
 #include "khct/json.hpp"
 
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
 using namespace khct;
 
 // Numbers
 static_assert(parse_json<"20 ">() == 20);
 static_assert(parse_json<" -30">() == -30);
+static_assert(parse_json<"0">() == 0);
+static_assert(parse_json<"-9223372036854775808">() == std::numeric_limits<std::int64_t>::lowest());
+static_assert(parse_json<"18446744073709551615">() == std::numeric_limits<std::uint64_t>::max());
 
 // Floats
-constexpr auto abs_ = [](auto x) { return x < 0 ? -x : x; };
 static_assert(parse_json<"3.25">() == 3.25);
 static_assert(parse_json<"-3.5">() == -3.5);
 static_assert(parse_json<"1e20">() == 1e20);
 static_assert(parse_json<"-5e+4">() == -5e+4);
-static_assert(abs_(parse_json<"25e-2">() - 25e-2) <= 0.0001);
+static_assert(parse_json<"25e-2">() == 25e-2);
+static_assert(parse_json<"0.125">() == 0.125);
+static_assert(parse_json<"1.2e10">() == 1.2e10);
+// Correctly rounded however large the exponent or however many digits there are
+static_assert(parse_json<"1e300">() == 1e300);
+static_assert(parse_json<"-1.7976931348623157e308">() == -1.7976931348623157e308);
+static_assert(parse_json<"1.7976931348623159e308">() == std::numeric_limits<double>::infinity());
+static_assert(parse_json<"2.2250738585072011e-308">() == 2.2250738585072011e-308);
+static_assert(parse_json<"4.9e-324">() == std::numeric_limits<double>::denorm_min());
+static_assert(parse_json<"1e-400">() == 0);
+static_assert(parse_json<"0.000000000000000000000000000000000000000001">() == 1e-42);
+static_assert(parse_json<"3.14159265358979323846264338327950288">() == 3.14159265358979323846264338327950288);
+// Halfway between two doubles rounds to even, and any digit after halfway rounds up
+static_assert(parse_json<"9007199254740993">() == 9007199254740992.0);
+static_assert(parse_json<"9007199254740993.0000000000000000001">() == 9007199254740994.0);
+static_assert(parse_json<"9007199254740995">() == 9007199254740996.0);
+// 2^-1075, halfway between zero and the smallest subnormal
+constexpr string halfway_to_denorm_min{
+   "0.000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+   "00000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000"
+   "00000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000000024703"
+   "28229206232720882843964341106861825299013071623822127928412503377536351043759326499181808179961898982823477228"
+   "58865463328355177969898199387398005390939063150356595155702263922908583924491051844359318028499365361525003193"
+   "70457678249219365623669863658480757001585769269903706311928279558551332927834338409351978015531246597263579574"
+   "62276646527282722005637400648549997709659947045402082816622623785739345073633900796776193057750674017632467360"
+   "09689513405355374585166611342237666786041621596804619144672918403005300575308490487653917113865916462395249126"
+   "23653881879636239373280423891018672348497668235089863388587925628302755995657524455507255189313690836254779186"
+   "948667994968324049705821028513185451396213837722826145437693412532098591327667236328125"};
+static_assert(parse_json<halfway_to_denorm_min>() == 0.0);
+static_assert(parse_json<halfway_to_denorm_min + string{"1"}>() == std::numeric_limits<double>::denorm_min());
 
 // Strings
 static_assert(parse_json<R"( "hi" )">() == string{"hi"});
@@ -30,6 +68,7 @@ static_assert(parse_json<"[1]">() == tuple{1u});
 static_assert(parse_json<"[1, 2]">() == tuple{1u, 2u});
 static_assert(parse_json<"[true, null]">() == tuple{true, null});
 static_assert(parse_json<"[true, false]">() == tuple{true, false});
+static_assert(parse_json<"[[1], [[2, 3]], []]">() == tuple{tuple{1u}, tuple{tuple{2u, 3u}}, tuple{}});
 
 // Objects
 static_assert(parse_json<"{}">().get<"">() == nil);
@@ -43,11 +82,281 @@ constexpr auto test_map = parse_json<R"({
    }
 })">();
 static_assert(test_map.get<"object">().get<"array">() == tuple{true, false, 3u});
+static_assert(test_map.visit("float", []<typename T>(const T&) { return std::same_as<T, double>; }));
+static_assert(!test_map.visit("floa", []<typename T>(const T&) { return std::same_as<T, double>; }));
+static_assert(parse_json<R"({"a": {}, "b": [{"c": "d"}]})">().get<"b">().get<0>().get<"c">() == string{"d"});
+
+// JSON pointers
+static_assert(at<"/object/array/2">(test_map) == 3u);
+static_assert(at<"/object/array">(test_map) == tuple{true, false, 3u});
+static_assert(at<"/float">(test_map) == 1.2e10);
+static_assert(&at<"">(test_map) == &test_map);
+static_assert(at<"/object/array/3">(test_map) == nil);
+static_assert(at<"/object/array/-">(test_map) == nil);
+static_assert(at<"/object/array/01">(test_map) == nil);
+static_assert(at<"/floa">(test_map) == nil);
+static_assert(at<"/float/0">(test_map) == nil);
+constexpr auto escaped_names = parse_json<R"({"a/b": {"m~n": 1}, "": {"": 2}})">();
+static_assert(at<"/a~1b/m~0n">(escaped_names) == 1u);
+static_assert(at<"//">(escaped_names) == 2u);
+static_assert(!detail::json_pointer<"a">.valid);
+static_assert(!detail::json_pointer<"/a~2">.valid);
+static_assert(!detail::json_pointer<"/a~">.valid);
+static_assert(parse_json_at<R"({"a": [0, {"b": [1, 2]}], "c": {"a": 4}})", "/a/1/b/1">() == 2u);
+static_assert(parse_json_at<R"({"a": [0, {"b": [1, 2]}], "c": {"a": 4}})", "/c">().get<"a">() == 4u);
+static_assert(parse_json_at<R"({"a": [0, {"b": [1, 2]}], "c": {"a": 4}})", "/a/2">() == nil);
+static_assert(parse_json_at<R"({"a": 1, "a": 2})", "/a">() == 1u);
+static_assert(parse_json_at<R"({"a/b": {"m~n": 1}})", "/a~1b/m~0n">() == 1u);
+static_assert(parse_json_at<R"([1, 2])", "">() == tuple{1u, 2u});
+static_assert(parse_json_at<R"({"a": 1,})", "/a">() == json_error::invalid_string);
+// Names are matched exactly, trailing spaces included
+static_assert(at<"/a ">(parse_json<R"({"a ": 1})">()) == 1u);
+static_assert(at<"/a">(parse_json<R"({"a ": 1})">()) == nil);
+static_assert(at<"/a ">(parse_json<R"({"a ": 1, "bcd": 2})">()) == 1u);
+static_assert(at<"/a">(parse_json<R"({"a ": 1, "bcd": 2})">()) == nil);
+static_assert(parse_json_at<R"({"a ": 1, "bcd": 2})", "/a ">() == 1u);
+static_assert(parse_json_at<R"({"a ": 1, "bcd": 2})", "/a">() == nil);
+
+// Lazily parsed documents
+constexpr auto manifest = parse_json_lazy<R"( {
+   "name": "service",
+   "ports": [80, 443],
+   "limits": {"cpu": 2, "memory": "4 GiB"},
+   "broken": [1, 2,, 3],
+   "name": "shadowed"
+} )">();
+static_assert(manifest.size() == 5);
+static_assert(manifest.get<"name">() == string{"service"});
+static_assert(manifest.get<"ports">() == tuple{80u, 443u});
+static_assert(at<"/memory">(manifest.get<"limits">()) == string{"4 GiB"});
+static_assert(manifest.get<"missing">() == nil);
+static_assert(manifest.get<0>() == nil);
+// Members are only checked when they're parsed
+static_assert(manifest.get<"broken">() == json_error::unexpected_input);
+static_assert(parse_json_lazy<R"([{"a": "]"}, [[]], 3])">().get<0>().get<"a">() == string{"]"});
+static_assert(parse_json_lazy<R"([{"a": "]"}, [[]], 3])">().get<1>() == tuple{tuple{}});
+static_assert(parse_json_lazy<R"([{"a": "]"}, [[]], 3])">().get<2>() == 3u);
+static_assert(parse_json_lazy<R"([{"a": "]"}, [[]], 3])">().get<3>() == nil);
+static_assert(parse_json_lazy<"[]">().size() == 0);
+static_assert(parse_json_lazy<"{}">().get<"a">() == nil);
+static_assert(parse_json_lazy<R"({"a": [1, 2})">().get<"a">() == json_error::unexpected_end_of_input);
+static_assert(parse_json_lazy<R"({"a": 1} 2)">().get<"a">() == json_error::remaining_input);
+static_assert(parse_json_lazy<R"({"a" 1})">().get<"a">() == json_error::unexpected_input);
+static_assert(parse_json_lazy<"1">().get<0>() == json_error::unexpected_input);
+
+// Nesting depth isn't limited by recursion in the tokenizer
+constexpr auto deep_array = []() consteval {
+   string<401> to_ret;
+   std::fill(to_ret.begin(), to_ret.begin() + 200, '[');
+   std::fill(to_ret.begin() + 200, to_ret.end() - 1, ']');
+   return to_ret;
+}();
+static_assert(!is_json_error(parse_json<deep_array>()));
 
 // Errors
 static_assert(parse_json<"9999999999999999999999999999999999999999999999">() == json_error::number_too_large);
 static_assert(parse_json<"2ee20">() == json_error::invalid_double);
 static_assert(parse_json<"2,3">() == json_error::remaining_input);
 static_assert(parse_json<"a">() == json_error::unexpected_input);
+static_assert(parse_json<"01">() == json_error::unexpected_input);
+static_assert(parse_json<"[1,]">() == json_error::unexpected_input);
+static_assert(parse_json<"[1 2]">() == json_error::unexpected_input);
+static_assert(parse_json<R"({"a" 1})">() == json_error::unexpected_input);
+static_assert(parse_json<R"({1: 2})">() == json_error::invalid_string);
+static_assert(parse_json<R"("abc)">() == json_error::invalid_string);
+static_assert(parse_json<R"({"a": 1)">() == json_error::unexpected_end_of_input);
+static_assert(parse_json<"[">() == json_error::unexpected_end_of_input);
+
+// Emitting
+static_assert(to_json_string<parse_json<R"( {"b": [1, -2, 3.5, true, false, null, "x\"y"], "a": {} } )">()>()
+              == R"({"a":{},"b":[1,-2,3.5,true,false,null,"x\"y"]})");
+static_assert(to_json_string<parse_json<"[]">()>() == "[]");
+static_assert(to_json_string<parse_json<"-9223372036854775808">()>() == "-9223372036854775808");
+static_assert(to_json_string<parse_json<"18446744073709551615">()>() == "18446744073709551615");
+static_assert(to_json_string<parse_json<"0">()>() == "0");
+static_assert(to_json_string<parse_json<"1.0">()>() == "1.0");
+static_assert(to_json_string<parse_json<"-0.0">()>() == "-0.0");
+static_assert(to_json_string<parse_json<"0.25">()>() == "0.25");
+static_assert(to_json_string<parse_json<"12.5e3">()>() == "12500.0");
+static_assert(to_json_string<parse_json<"1e21">()>() == "1e21");
+static_assert(to_json_string<parse_json<"1.5e-7">()>() == "1.5e-7");
+static_assert(to_json_string<1e-300>() == "1e-300");
+static_assert(to_json_string<std::numeric_limits<double>::min()>() == "2.2250738585072014e-308");
+static_assert(to_json_string<std::numeric_limits<double>::denorm_min()>() == "5e-324");
+static_assert(to_json_string<std::numeric_limits<double>::max()>() == "1.7976931348623157e308");
+static_assert(to_json_string<0.1>() == "0.1");
+static_assert(parse_json<to_json_string<1.0 / 3>()>() == 1.0 / 3);
+constexpr auto reparsed_test_map = parse_json<to_json_string<test_map>()>();
+static_assert(reparsed_test_map.get<"object">().get<"array">() == tuple{true, false, 3u});
+static_assert(reparsed_test_map.visit("float", []<typename T>(const T& value) {
+   if constexpr (std::same_as<T, double>) {
+      return value == 1.2e10;
+   }
+   return false;
+}));
+// Padding names to a common length doesn't confuse them with names that end in spaces
+constexpr auto spaced_names = parse_json<R"({"a ": 2, "a": 1, "bcd": 3})">();
+static_assert(spaced_names.get<"a">() == 1u);
+static_assert(spaced_names.get<"a ">() == 2u);
+constexpr auto spaced_value = []<typename T>(const T& value) -> std::uint64_t {
+   if constexpr (std::same_as<T, std::uint64_t>) {
+      return value;
+   }
+   return 0;
+};
+static_assert(spaced_names.visit("a", spaced_value) == 1);
+static_assert(spaced_names.visit("a ", spaced_value) == 2);
+static_assert(spaced_names.visit("a  ", spaced_value) == 0);
+static_assert(to_json_string<spaced_names>() == R"({"a":1,"a ":2,"bcd":3})");
+
+// Runtime parsing
+constexpr bool check_dom(std::string_view input, json_status expected)
+{
+   return json_dom{input}.status() == expected;
+}
+static_assert(check_dom("[1, 2]", json_status::ok));
+static_assert(check_dom("9999999999999999999999999999999999999999999999", json_status::number_too_large));
+static_assert(check_dom("2ee20", json_status::invalid_double));
+static_assert(check_dom("2,3", json_status::remaining_input));
+static_assert(check_dom("01", json_status::unexpected_input));
+static_assert(check_dom(R"({1: 2})", json_status::invalid_string));
+static_assert(check_dom("[", json_status::unexpected_end_of_input));
+static_assert(check_dom("", json_status::unexpected_end_of_input));
+
+constexpr auto dom_test_input = R"({
+   "float": 1.2e10,
+   "object": {
+      "array": [true, false, 3, -4, null, "\"s\""]
+   },
+   "empty": {}
+})";
+
+constexpr bool check_dom_values()
+{
+   const json_dom dom{dom_test_input};
+   const auto root = dom.root();
+   const auto array = root["object"]->operator[]("array");
+   auto element_count = 0;
+   for ([[maybe_unused]] const auto element : array->elements()) {
+      ++element_count;
+   }
+   auto member_names = std::string_view{};
+   for (const auto [name, value] : root.members()) {
+      member_names = member_names.empty() ? name : member_names;
+      if (name == "empty" && (value.kind() != json_kind::object || value.size() != 0)) {
+         return false;
+      }
+   }
+   return root.kind() == json_kind::object && root.size() == 3 && root["float"]->as_double() == 1.2e10
+       && !root["floa"] && array->size() == 6 && element_count == 6 && member_names == "float"
+       && (*array)[0]->as_bool() == true && (*array)[1]->as_bool() == false && (*array)[2]->as_unsigned() == 3u
+       && (*array)[2]->as_double() == 3.0 && (*array)[3]->as_signed() == -4 && !(*array)[3]->as_unsigned()
+       && (*array)[4]->is_null() && (*array)[5]->as_string() == R"(\"s\")" && !(*array)[6]
+       && !root["empty"]->operator[]("float") && root["empty"]->members().begin() == root["empty"]->members().end();
+}
+static_assert(check_dom_values());
+
+// Documents held by value
+constexpr json_document<16, 64> small_document{R"({"name": "khct", "sizes": [1, -2, 2.5], "empty": {}})"};
+static_assert(small_document.status() == json_status::ok);
+static_assert(small_document.node_count() == 10 && small_document.char_count() == 24);
+static_assert(small_document.root()["name"]->as_string() == "khct");
+static_assert((*small_document.root()["sizes"])[1]->as_signed() == -2);
+static_assert((*small_document.root()["sizes"])[2]->as_double() == 2.5);
+static_assert(small_document.root()["empty"]->size() == 0 && small_document.root()["empty"]->text().empty());
+static_assert(json_document<9, 64>{R"({"name": "khct", "sizes": [1, -2, 2.5], "empty": {}})"}.status()
+              == json_status::capacity_exceeded);
+static_assert(json_document<16, 23>{R"({"name": "khct", "sizes": [1, -2, 2.5], "empty": {}})"}.status()
+              == json_status::capacity_exceeded);
+static_assert(json_document<16, 64>{R"({"name": "khct",})"}.status() == json_status::invalid_string);
+constexpr auto exact_document = make_json_document<R"([{"a": [true, null]}, "b"])">();
+static_assert(std::same_as<decltype(exact_document), const json_document<7, 10>>);
+static_assert((*exact_document.root()[0])["a"]->operator[](1)->is_null());
+
+// Binary encoding
+constexpr auto binary = make_json_binary<R"({"name": "khct", "sizes": [1, -2, 2.5, 18446744073709551615],
+                                            "flags": [true, false, null], "empty": {}, "a": 1, "a": 2})">();
+static_assert(binary.bytes.size() == 74);
+static_assert(binary.root().size() == 6);
+static_assert(binary.root()["name"]->as_string() == "khct");
+static_assert((*binary.root()["sizes"])[0]->as_unsigned() == 1u && (*binary.root()["sizes"])[0]->as_double() == 1.0);
+static_assert((*binary.root()["sizes"])[1]->as_signed() == -2 && !(*binary.root()["sizes"])[1]->as_unsigned());
+static_assert((*binary.root()["sizes"])[2]->as_double() == 2.5);
+static_assert(!(*binary.root()["sizes"])[3]->as_signed());
+static_assert(!(*binary.root()["sizes"])[4]);
+static_assert((*binary.root()["flags"])[0]->as_bool() == true && (*binary.root()["flags"])[2]->is_null());
+static_assert(binary.root()["empty"]->size() == 0 && binary.root()["empty"]->kind() == json_kind::object);
+static_assert(binary.root()["a"]->as_unsigned() == 1u);
+static_assert(!binary.root()["b"] && !binary.root()[0] && !binary.root()["name"]->operator[]("name"));
+static_assert(binary.root().member(0).first == "a" && binary.root().member(5).first == "sizes");
+static_assert(make_json_binary<"[1,">() == json_error::unexpected_end_of_input);
+// Integers below 8 in magnitude and strings shorter than 15 characters only add a tag byte
+static_assert(make_json_binary<R"([7, -8, "abc"])">().bytes.size() == 11);
+constexpr auto wide_binary = make_json_binary<
+   R"([8, -9223372036854775808, 0.1, 1e300, "fifteen chars!!", )"
+   R"("a string long enough that its length takes two bytes as a varint, which is anything from 128 )"
+   R"(up to 16383 characters, and that takes the array past 256 bytes, so that the offsets of its elements )"
+   R"(take two bytes each as well; the width is chosen for each array or object on its own"])">();
+constexpr auto wide = wide_binary.root();
+static_assert(wide[0]->as_unsigned() == 8u);
+static_assert(wide[1]->as_signed() == std::numeric_limits<std::int64_t>::min());
+static_assert(wide[2]->as_double() == 0.1 && wide[3]->as_double() == 1e300);
+static_assert(wide[4]->as_string() == "fifteen chars!!");
+static_assert(wide[5]->as_string()->size() == 278 && wide[5]->as_string()->ends_with("on its own"));
+// Past 256 bytes, so the offsets in the array take two bytes
+static_assert(wide_binary.bytes[0] >> 4 == 1);
+constexpr auto binary_from_value = to_json_binary<test_map>();
+static_assert(binary_from_value.root()["object"]->operator[]("array")->operator[](2)->as_unsigned() == 3u);
+static_assert(to_json_binary<spaced_names>().root()["a "]->as_unsigned() == 2u);
+static_assert(to_json_binary<spaced_names>().root()["a"]->as_unsigned() == 1u);
+
+bool check_runtime_dom()
+{
+   // The same json_dom is reused for both documents
+   json_dom dom;
+   volatile auto opaque = '7';
+   const std::string first = std::string{"[1, [2, 3], {\"a\": "} + opaque + "}]";
+   if (dom.parse(first) != json_status::ok || dom.root()[2]->operator[]("a")->as_unsigned() != 7u) {
+      return false;
+   }
+   const std::string second = std::string{"{\"b\": "} + opaque + opaque;
+   return dom.parse(second) == json_status::unexpected_end_of_input && check_dom_values();
+}
+
+bool check_runtime_doubles()
+{
+   // Random doubles printed with up to 40 digits, so some need more than the first 19 digits to round correctly
+   std::mt19937_64 rng{42};
+   char buffer[64];
+   for (int i = 0; i < 100'000; ++i) {
+      const auto value = std::bit_cast<double>(rng());
+      if (value != value) {
+         continue;
+      }
+      std::snprintf(buffer, sizeof(buffer), "%.*e", static_cast<int>(rng() % 40), value);
+      if (detail::to_double(buffer) != std::strtod(buffer, nullptr)) {
+         return false;
+      }
+   }
+   return true;
+}
+
+bool check_runtime_document()
+{
+   static constexpr auto document = make_json_document<R"({"ports": [80, 443, 8080]})">();
+   volatile std::size_t opaque = 2;
+   return (*document.root()["ports"])[opaque]->as_unsigned() == 8080u;
+}
+
+bool check_runtime_binary()
+{
+   static constexpr auto document = make_json_binary<R"({"ports": [80, 443, 8080], "host": "localhost"})">();
+   volatile std::size_t opaque = 2;
+   return (*document.root()["ports"])[opaque]->as_unsigned() == 8080u
+       && document.root()["host"]->as_string() == "localhost";
+}
 
-int main() {}
+int main()
+{
+   return check_runtime_dom() && check_runtime_doubles() && check_runtime_document() && check_runtime_binary() ? 0 : 1;
+}
@@ -0,0 +1,149 @@
+#include "khct/json_schema.hpp"
+
+#include <string>
+
+using namespace khct;
+
+constexpr string message_schema = R"({
+   "id": 0,
+   "delta": -1,
+   "price": 0.0,
+   "name": "unnamed",
+   "active": false,
+   "position": [0.0, 0.0],
+   "owner": {"id": 0, "admin": false},
+   "note": null
+})";
+
+using message = json_schema_t<message_schema>;
+
+// Members start out as the schema's values
+static_assert(message{}.get<"id">() == 0u);
+static_assert(message{}.get<"name">() == "unnamed");
+static_assert(std::same_as<std::remove_cvref_t<decltype(message{}.get<"delta">())>, std::int64_t>);
+static_assert(std::same_as<std::remove_cvref_t<decltype(message{}.get<"price">())>, double>);
+static_assert(std::same_as<std::remove_cvref_t<decltype(message{}.get<"owner">().get<"admin">())>, bool>);
+
+constexpr auto read_message(std::string_view input)
+{
+   pair<json_status, message> to_ret{};
+   to_ret.first = read_json<message_schema>(input, to_ret.second);
+   return to_ret;
+}
+
+constexpr auto full = read_message(R"({
+   "note": null, "name": "widget", "id": 42, "delta": -7, "price": 2.5,
+   "unknown": {"nested": ["]", {"x": 1}]}, "active": true, "position": [1, -2.5],
+   "owner": {"admin": true, "id": 3, "extra": "ignored"}
+})");
+static_assert(full.first == json_status::ok);
+static_assert(full.second.get<"id">() == 42u);
+static_assert(full.second.get<"delta">() == -7);
+static_assert(full.second.get<"price">() == 2.5);
+static_assert(full.second.get<"name">() == "widget");
+static_assert(full.second.get<"active">());
+static_assert(full.second.get<"position">() == tuple{1.0, -2.5});
+static_assert(full.second.get<"owner">().get<"id">() == 3u);
+static_assert(full.second.get<"owner">().get<"admin">());
+
+// Missing members keep their defaults
+constexpr auto partial = read_message(R"({"delta": 5, "active": false})");
+static_assert(partial.first == json_status::ok);
+static_assert(partial.second.get<"delta">() == 5);
+static_assert(partial.second.get<"name">() == "unnamed");
+
+// Errors
+static_assert(read_message(R"({"id": -1})").first == json_status::unexpected_input);
+static_assert(read_message(R"({"id": 1.5})").first == json_status::unexpected_input);
+static_assert(read_message(R"({"name": 1})").first == json_status::unexpected_input);
+static_assert(read_message(R"({"active": null})").first == json_status::unexpected_input);
+static_assert(read_message(R"({"position": [1]})").first == json_status::unexpected_input);
+static_assert(read_message(R"({"position": [1, 2, 3]})").first == json_status::unexpected_input);
+static_assert(read_message(R"({"id": 99999999999999999999})").first == json_status::number_too_large);
+static_assert(read_message(R"({"price": 1e})").first == json_status::invalid_double);
+static_assert(read_message(R"({"name": "abc)").first == json_status::invalid_string);
+static_assert(read_message(R"({1: 2})").first == json_status::invalid_string);
+static_assert(read_message(R"({"id": 1)").first == json_status::unexpected_end_of_input);
+static_assert(read_message(R"({"unknown": [1, 2)").first == json_status::unexpected_end_of_input);
+static_assert(read_message(R"({} 1)").first == json_status::remaining_input);
+static_assert(read_message("[]").first == json_status::unexpected_input);
+
+static_assert([]() {
+   auto to_read = json_schema_defaults<"[1, \"a\"]">;
+   return read_json<"[1, \"a\"]">(R"([2, "b"])", to_read) == json_status::ok
+       && to_read == tuple{2u, std::string_view{"b"}};
+}());
+
+bool check_runtime_read()
+{
+   volatile auto opaque = '9';
+   const std::string input = std::string{R"({"id": )"} + opaque + R"(, "owner": {"id": 1)" + opaque + "}}";
+   message to_read;
+   return read_json<message_schema>(input, to_read) == json_status::ok && to_read.get<"id">() == 9u
+       && to_read.get<"owner">().get<"id">() == 19u;
+}
+
+// Writing
+constexpr string counters_schema = R"({"hits": 0, "misses": 0, "tags": ["", ""], "last": {"ok": true, "by": -1}})";
+
+static_assert(detail::json_schema_fragments<counters_schema>[0] == R"({"hits":)");
+static_assert(detail::json_schema_fragments<counters_schema>[2] == R"(,"tags":[")");
+static_assert(detail::json_schema_fragments<counters_schema>[3] == R"(",")");
+static_assert(detail::json_schema_fragments<counters_schema>[6] == "}}");
+
+constexpr auto write_counters(std::size_t buffer_size)
+{
+   json_schema_t<counters_schema> counters;
+   counters.get<"hits">() = 18446744073709551615u;
+   counters.get<"tags">() = tuple{std::string_view{"a"}, std::string_view{R"(\"b)"}};
+   counters.get<"last">().get<"ok">() = false;
+   counters.get<"last">().get<"by">() = std::numeric_limits<std::int64_t>::lowest();
+   std::array<char, 256> buffer{};
+   const auto size = write_json<counters_schema>(counters, std::span{buffer.data(), buffer_size});
+   return pair{size, buffer};
+}
+
+constexpr std::string_view expected_counters
+   = R"({"hits":18446744073709551615,"misses":0,"tags":["a","\"b"],"last":{"ok":false,"by":-9223372036854775808}})";
+static_assert(write_counters(256).first == expected_counters.size());
+static_assert(std::string_view{write_counters(256).second.data(), expected_counters.size()} == expected_counters);
+static_assert(write_counters(expected_counters.size()).first == expected_counters.size());
+static_assert(!write_counters(expected_counters.size() - 1).first);
+
+static_assert([]() {
+   std::array<char, 16> buffer{};
+   return write_json<R"([null, {}])">(json_schema_defaults<R"([null, {}])">, buffer) == 9
+       && std::string_view{buffer.data(), 9} == "[null,{}]";
+}());
+
+bool check_runtime_write()
+{
+   message to_write;
+   volatile double opaque = 0.1;
+   to_write.get<"price">() = opaque;
+   to_write.get<"position">() = tuple{-1.5, 1e300};
+   char buffer[256];
+   const auto size = write_json<message_schema>(to_write, buffer);
+   message to_read;
+   return size
+       && std::string_view{buffer, *size}
+             == R"({"id":0,"delta":-1,"price":0.1,"name":"unnamed","active":false,"position":[-1.5,1e+300],)"
+                R"("owner":{"id":0,"admin":false},"note":null})"
+       && read_json<message_schema>({buffer, *size}, to_read) == json_status::ok && to_read.get<"price">() == opaque;
+}
+
+// JSON has no infinities or NaN, so they aren't written
+bool check_runtime_write_non_finite()
+{
+   message to_write;
+   char buffer[256];
+   to_write.get<"price">() = std::numeric_limits<double>::infinity();
+   const auto infinite = write_json<message_schema>(to_write, buffer);
+   to_write.get<"price">() = 0;
+   to_write.get<"position">() = tuple{0.0, std::numeric_limits<double>::quiet_NaN()};
+   const auto nan = write_json<message_schema>(to_write, buffer);
+   to_write.get<"position">() = tuple{0.0, 0.0};
+   return !infinite && !nan && write_json<message_schema>(to_write, buffer);
+}
+
+int main() { return check_runtime_read() && check_runtime_write() && check_runtime_write_non_finite() ? 0 : 1; }
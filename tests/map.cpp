@@ -1,6 +1,9 @@
 #include "khct/map.hpp"
 #include "khct/string.hpp"
 
+#include <cstdint>
+#include <limits>
+
 using namespace khct;
 
 constexpr auto map1 = make_map<int, int>({{3, 4}, {4, 5}});
@@ -14,6 +17,167 @@ constexpr auto map3 = merge(map1, map2);
 static_assert(map3[3] == 4);
 static_assert(map3[6] == 7);
 
+static_assert(!map1[2]);
+
+constexpr auto eytzinger1
+   = make_map<int, int>({{6, 7}, {3, 4}, {5, 6}, {4, 5}, {9, 1}}, std::less<>{}, eytzinger_layout{});
+static_assert(eytzinger1[3] == 4);
+static_assert(eytzinger1[9] == 1);
+static_assert(!eytzinger1[2]);
+static_assert(!eytzinger1[7]);
+static_assert(!eytzinger1[10]);
+static_assert(std::ranges::is_sorted(eytzinger1, std::less<>{}, &std::pair<int, int>::first));
+static_assert(merge(eytzinger1, make_map<int, int>({{1, 2}}, std::less<>{}, eytzinger_layout{}))[1] == 2);
+
+constexpr auto eytzinger_big = []() consteval {
+   std::pair<int, int> to_ret[100];
+   for (int i = 0; i < 100; ++i) {
+      to_ret[i] = {(i * 37) % 100 * 2, i};
+   }
+   return make_map(to_ret, std::less<>{}, eytzinger_layout{});
+}();
+static_assert(std::ranges::is_sorted(eytzinger_big, std::less<>{}, &std::pair<int, int>::first));
+static_assert(std::ranges::all_of(eytzinger_big, [](const auto& p) { return eytzinger_big[p.first] == p.second; }));
+static_assert(
+   std::ranges::none_of(std::views::iota(0, 100), [](int i) { return eytzinger_big[i * 2 + 1].has_value(); }));
+
+struct large_value {
+   int value;
+   char padding[256] = {};
+};
+constexpr auto soa1 = make_map<int, large_value>({{6, {7}}, {3, {4}}, {5, {6}}}, std::less<>{}, soa_layout{});
+static_assert(soa1[3]->value == 4);
+static_assert(soa1[6]->value == 7);
+static_assert(!soa1[4]);
+static_assert(soa1.begin()->first == 3);
+static_assert(std::ranges::is_sorted(soa1 | std::views::keys));
+constexpr auto soa2 = merge(soa1, make_map<int, large_value>({{1, {2}}}, std::less<>{}, soa_layout{}));
+static_assert(soa2[1]->value == 2);
+static_assert(soa2[5]->value == 6);
+
+constexpr auto small_map = []() consteval {
+   std::pair<std::int64_t, int> to_ret[50];
+   for (int i = 0; i < 50; ++i) {
+      to_ret[i] = {i * 3 - 60, i};
+   }
+   return make_map(to_ret, std::less<>{}, simd_layout{});
+}();
+static_assert(
+   std::same_as<decltype(small_map)::layout_storage, simd_layout::storage<std::int64_t, int, 50, std::less<>>>);
+static_assert(small_map[-60] == 0);
+static_assert(small_map[87] == 49);
+static_assert(!small_map[88]);
+static_assert(std::ranges::is_sorted(small_map | std::views::keys));
+
+// Empty maps of every layout find nothing and iterate as empty
+template<typename Layout>
+consteval bool check_empty()
+{
+   const map<int, int, 0, std::less<>, Layout> empty{};
+   auto count = 0;
+   for ([[maybe_unused]] const auto& kv : empty) {
+      ++count;
+   }
+   return count == 0 && std::ranges::empty(empty) && !empty[0] && empty.size() == 0;
+}
+static_assert(check_empty<sorted_layout>());
+static_assert(check_empty<eytzinger_layout>());
+static_assert(check_empty<soa_layout>());
+static_assert(check_empty<simd_layout>());
+static_assert(merge(map<int, int, 0, std::less<>, eytzinger_layout>{}, eytzinger1)[9] == 1);
+
+// The default stays sorted_layout whatever the key type, so iteration yields mutable std::pair elements
+static_assert(std::same_as<decltype(map1)::layout_storage, sorted_layout::storage<int, int, 2, std::less<>>>);
+static_assert([]() consteval {
+   auto m = make_map<int, int>({{1, 2}, {3, 4}});
+   for (auto& kv : m) {
+      kv.second += 1;
+   }
+   return m[1] == 3 && m[3] == 5;
+}());
+
+template<typename Key>
+bool check_simd_lookups()
+{
+   constexpr auto to_check = []() consteval {
+      std::pair<Key, int> to_ret[40];
+      for (int i = 0; i < 40; ++i) {
+         to_ret[i] = {static_cast<Key>(i * 2 + 1), i};
+      }
+      return make_map(to_ret, std::less<>{}, simd_layout{});
+   }();
+   // volatile so the lookups aren't constant folded
+   volatile int limit = 82;
+   for (int i = 0; i < limit; ++i) {
+      const auto expected = i % 2 == 1 && i < 80 ? std::optional<int>{i / 2} : std::nullopt;
+      if (to_check[static_cast<Key>(i)] != expected) {
+         return false;
+      }
+   }
+   return true;
+}
+
+constexpr auto base_config = make_map<int, int>({{1, 10}, {2, 20}, {4, 40}, {6, 60}});
+constexpr auto overrides = make_map<int, int>({{2, 2}, {3, 3}, {6, 6}});
+constexpr auto merged_right = merge<base_config, overrides>(keep_right);
+static_assert(merged_right.size() == 5);
+static_assert(merged_right[1] == 10 && merged_right[2] == 2 && merged_right[3] == 3 && merged_right[6] == 6);
+static_assert(merge<base_config, overrides>(keep_left)[2] == 20);
+static_assert(merge<base_config, overrides>([](int a, int b) { return a + b; })[6] == 66);
+static_assert(merge<map1, map2>().size() == 4);
+static_assert(!detail::conflict_policy<std::string_view, decltype(base_config)>);
+
+constexpr auto common = intersect<base_config, overrides>();
+static_assert(common.size() == 2 && common[2] == 20 && common[6] == 60 && !common[1]);
+static_assert(intersect<base_config, overrides>(keep_right)[2] == 2);
+static_assert(std::ranges::equal(difference<base_config, overrides>() | std::views::keys, std::array{1, 4}));
+
+// Inputs with other layouts are walked in sorted order
+static_assert(std::ranges::equal(merge<soa1, soa2>(keep_left) | std::views::keys, std::array{1, 3, 5, 6}));
+static_assert(std::ranges::equal(intersect<eytzinger1, base_config>() | std::views::values, std::array{5, 7}));
+
+constexpr auto small_set = make_set({5, 1, 3});
+constexpr auto other_set = make_set({3, 4, 5, 9});
+static_assert(small_set.contains(3) && !small_set.contains(2));
+static_assert(std::ranges::equal(small_set, std::array{1, 3, 5}));
+static_assert(std::ranges::equal(merge<small_set, other_set>(), std::array{1, 3, 4, 5, 9}));
+static_assert(std::ranges::equal(intersect<small_set, other_set>(), std::array{3, 5}));
+static_assert(std::ranges::equal(difference<other_set, small_set>(), std::array{4, 9}));
+static_assert(std::same_as<decltype(difference<other_set, small_set>()), set<int, 2>>);
+static_assert(difference<small_set, small_set>().size() == 0);
+
+// Maps can be restricted to or have removed the keys of a set
+static_assert(std::ranges::equal(intersect<base_config, small_set>() | std::views::keys, std::array{1}));
+static_assert(std::ranges::equal(difference<base_config, small_set>() | std::views::keys, std::array{2, 4, 6}));
+
+constexpr auto perfect1 = make_perfect_map<int, int>({{3, 4}, {4, 5}, {10, 11}, {-2, 8}, {100, 1}});
+static_assert(perfect1[3] == 4);
+static_assert(perfect1[-2] == 8);
+static_assert(perfect1[100] == 1);
+static_assert(!perfect1[5]);
+
+constexpr auto perfect2 = make_perfect_map(map3);
+static_assert(perfect2[5] == 6);
+static_assert(!perfect2[7]);
+
+constexpr auto perfect_empty = make_perfect_map(map<int, int, 0, std::less<>>{});
+static_assert(!perfect_empty[0] && !perfect_empty[7]);
+static_assert(std::ranges::empty(perfect_empty));
+
+constexpr auto perfect_big = make_perfect_map([]() consteval {
+   std::pair<int, int> to_ret[256];
+   for (int i = 0; i < 256; ++i) {
+      to_ret[i] = {i * 7919, i};
+   }
+   return map<int, int, 256, std::less<void>>{to_ret};
+}());
+static_assert(std::ranges::all_of(perfect_big, [](const auto& p) { return perfect_big[p.first] == p.second; }));
+static_assert(!perfect_big[1]);
+
+constexpr auto perfect_str = make_perfect_map<std::string_view, int>({{"alpha", 1}, {"beta", 2}, {"gamma", 3}});
+static_assert(perfect_str["beta"] == 2);
+static_assert(!perfect_str["delta"]);
+
 constexpr auto type_map = make_multi_type_map<{1, 4}, {3, 2.2}, {2, true}>();
 
 static_assert(type_map.get<2>() == true);
@@ -27,4 +191,65 @@ static_assert(type_map2.get<string{"alpaca"}>() == 'a');
 static_assert(type_map2.get<string{"banana"}>() == 2);
 static_assert(type_map2.get<string{"test"}>() == 't');
 
-int main() {}
+constexpr auto describe = []<typename T>(const T& value) {
+   if constexpr (std::same_as<T, int>) {
+      return value;
+   }
+   else if constexpr (std::same_as<T, double>) {
+      return 10;
+   }
+   else if constexpr (std::same_as<T, bool>) {
+      return value ? 20 : 30;
+   }
+   else if constexpr (std::same_as<T, char>) {
+      return static_cast<int>(value);
+   }
+   else {
+      return -1;
+   }
+};
+static_assert(type_map.visit(1, describe) == 4);
+static_assert(type_map.visit(2, describe) == 20);
+static_assert(type_map.visit(3, describe) == 10);
+static_assert(type_map.visit(4, describe) == -1);
+static_assert(type_map.visit(-100, describe) == -1);
+
+constexpr auto sparse_type_map = make_multi_type_map<{1000, 4}, {-7, 2.2}, {123456, 'a'}>();
+static_assert(sparse_type_map.visit(123456, describe) == 'a');
+static_assert(sparse_type_map.visit(-7, describe) == 10);
+static_assert(sparse_type_map.visit(7, describe) == -1);
+
+// Keys spanning the whole 64 bit range, where the number of keys covered doesn't fit in 64 bits
+constexpr auto extreme_signed_map = make_multi_type_map<
+   pair{std::numeric_limits<std::int64_t>::min(), 4},
+   pair{std::numeric_limits<std::int64_t>::max(), true}>();
+static_assert(extreme_signed_map.visit(std::numeric_limits<std::int64_t>::min(), describe) == 4);
+static_assert(extreme_signed_map.visit(std::numeric_limits<std::int64_t>::max(), describe) == 20);
+static_assert(extreme_signed_map.visit(0, describe) == -1);
+constexpr auto extreme_unsigned_map
+   = make_multi_type_map<pair{std::uint64_t{0}, 4}, pair{std::numeric_limits<std::uint64_t>::max(), 'a'}>();
+static_assert(extreme_unsigned_map.visit(0, describe) == 4);
+static_assert(extreme_unsigned_map.visit(std::numeric_limits<std::uint64_t>::max(), describe) == 'a');
+static_assert(extreme_unsigned_map.visit(1, describe) == -1);
+
+static_assert(type_map2.visit("alpaca", describe) == 'a');
+static_assert(type_map2.visit("test", describe) == 't');
+static_assert(type_map2.visit("banana", describe) == 2);
+static_assert(type_map2.visit("tes", describe) == -1);
+static_assert(type_map2.visit("", describe) == -1);
+
+bool check_runtime_visit()
+{
+   volatile int opaque = 3;
+   const int key = opaque;
+   const std::string_view str_key = key == 3 ? "banana" : "test";
+   return type_map.visit(key, describe) == 10 && type_map2.visit(str_key, describe) == 2;
+}
+
+int main()
+{
+   return check_runtime_visit() && check_simd_lookups<std::int8_t>() && check_simd_lookups<std::uint16_t>()
+             && check_simd_lookups<int>() && check_simd_lookups<std::uint64_t>()
+           ? 0
+           : 1;
+}
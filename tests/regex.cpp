@@ -0,0 +1,91 @@
+#include "khct/regex.hpp"
+
+#include <algorithm>
+#include <array>
+#include <string>
+
+using namespace khct;
+
+using identifier = regex<"[A-Za-z_][A-Za-z0-9_]*">;
+static_assert(identifier::match("snake_case_1"));
+static_assert(identifier::match(string{"_"}));
+static_assert(identifier::match(string_ref<"a b", 0, 1>{}));
+static_assert(!identifier::match("1abc"));
+static_assert(!identifier::match(""));
+static_assert(!identifier::match("has space"));
+
+static_assert(regex<"">::match(""));
+static_assert(!regex<"">::match("a"));
+static_assert(regex<"a|bc|">::match("bc") && regex<"a|bc|">::match("") && !regex<"a|bc|">::match("b"));
+static_assert(regex<"(ab)+c?">::match("ababc") && !regex<"(ab)+c?">::match("abb"));
+static_assert(regex<"(?:x|y)*">::match("xyyx"));
+static_assert(regex<"a{2,3}">::match("aa") && regex<"a{2,3}">::match("aaa") && !regex<"a{2,3}">::match("aaaa"));
+static_assert(regex<"a{2}">::match("aa") && !regex<"a{2}">::match("a"));
+static_assert(regex<"a{2,}">::match("aaaaa") && !regex<"a{2,}">::match("a"));
+static_assert(regex<"((a*)*|b)*">::match("abba"));
+static_assert(regex<".">::match("x") && !regex<".">::match("\n"));
+static_assert(regex<R"(\d+\.\d*)">::match("3.") && !regex<R"(\d+\.\d*)">::match("3x"));
+static_assert(regex<R"(\w\W\s\S\D)">::match("a- xy"));
+static_assert(regex<R"(\x41\t\\)">::match("A\t\\"));
+static_assert(regex<"[]a-c-]+">::match("]-ab") && !regex<"[]a-c-]+">::match("d"));
+static_assert(regex<"[^0-9\\s]">::match("a") && !regex<"[^0-9\\s]">::match("5") && !regex<"[^0-9\\s]">::match(" "));
+static_assert(regex<"[\\x00-\\x1f]">::match("\x1f") && !regex<"[\\x00-\\x1f]">::match(" "));
+static_assert(regex<"\xff">::match("\xff"));
+
+// Equivalent states are merged and bytes no transition tells apart share a class; the dead state is the only other one
+static_assert(detail::regex_tables<"(a|b)*abb">.accepting.size() == 5);
+static_assert(detail::regex_tables<"a*a*a*">.accepting.size() == 2);
+static_assert(detail::regex_tables<"[a-z]+">.transitions.size() == 3 * 2);
+
+// Leftmost and then longest, unlike ECMAScript's leftmost first
+static_assert(regex<"a|ab">::search("xxabab") == "ab");
+static_assert(regex<"b+">::search("abbbcb") == "bbb");
+static_assert(regex<"x*">::search("abc") == "");
+static_assert(!regex<"z">::search("abc"));
+
+static_assert(std::ranges::equal(regex<"[0-9]+">::find_all("a1b22c333"), std::array{"1", "22", "333"}));
+static_assert(std::ranges::equal(regex<"a*">::find_all("baac"), std::array{"", "aa", "", ""}));
+static_assert(std::ranges::distance(regex<"q">::find_all("abc")) == 0);
+static_assert(std::ranges::input_range<regex<"q">::match_range>);
+
+// Text that keeps beginning a match without completing one isn't scanned again from every start
+constexpr auto unfinished_matches = []() consteval {
+   string<5003> to_ret;
+   std::fill(to_ret.begin(), to_ret.begin() + 5000, 'a');
+   to_ret.value_[5000] = 'x';
+   to_ret.value_[5001] = 'b';
+   return to_ret;
+}();
+constexpr auto unfinished_text = std::string_view{unfinished_matches.begin(), unfinished_matches.size()};
+static_assert(regex<"a*b">::search(unfinished_text) == "b");
+static_assert(!regex<"a*c">::search(unfinished_text));
+static_assert(std::ranges::equal(regex<"a*y|b">::find_all(unfinished_text), std::array{"b"}));
+static_assert(regex<"a*b|c">::search("aaaaaac") == "c");
+static_assert(regex<"ab*c|b">::search("xabbbc") == "abbbc");
+
+// Invalid or unsupported patterns
+static_assert(!detail::regex_tables<"(a">.valid);
+static_assert(!detail::regex_tables<"a)">.valid);
+static_assert(!detail::regex_tables<"*a">.valid);
+static_assert(!detail::regex_tables<"[a">.valid);
+static_assert(!detail::regex_tables<"[z-a]">.valid);
+static_assert(!detail::regex_tables<"a{3,2}">.valid);
+static_assert(!detail::regex_tables<"a{1001}">.valid);
+static_assert(!detail::regex_tables<"^a$">.valid);
+static_assert(!detail::regex_tables<R"(\q)">.valid);
+static_assert(!detail::regex_tables<R"(\x4)">.valid);
+
+bool check_runtime_regex()
+{
+   const std::string input = "GET /items/42 /users/7/orders/1009";
+   std::string digits;
+   for (const auto number : regex<"[0-9]+">::find_all(input)) {
+      digits += number;
+      digits += ',';
+   }
+   const auto path = regex<"(/[a-z]+/[0-9]+)+">::search(input);
+   return digits == "42,7,1009," && path && *path == "/items/42"
+       && regex<"[A-Z]+ /.*">::match(input);
+}
+
+int main() { return check_runtime_regex() ? 0 : 1; }
@@ -14,9 +14,48 @@ static_assert(pad_right<2>(string{"test"}) == "test  ");
 
 static_assert(string{"a"} + string{"Bc"} == "aBc");
 
-static_assert(split<string{"a,b,c"}, ','>() == std::tuple{string{"a"}, string{"b"}, string{"c"}});
-static_assert(split<string{"a,b,c"}, ',', 1>() == std::tuple{string{"a"}, string{"b,c"}});
+static_assert(std::ranges::equal(split<string{"a,b,c"}, ','>(), std::array<std::string_view, 3>{"a", "b", "c"}));
+static_assert(std::ranges::equal(split<string{"a,b,c"}, ',', 1>(), std::array<std::string_view, 2>{"a", "b,c"}));
+static_assert(split<string{"a,,b,"}, ','>().size() == 4);
+static_assert(split<string{"a,,b,"}, ','>()[1].empty() && split<string{"a,,b,"}, ','>()[3].empty());
+static_assert(split<"", ','>().size() == 1);
 
 static_assert(strip_leading_whitespace<"  \nab">() == "ab");
+static_assert(strip_leading_whitespace<"   ">().empty());
 
-int main() {}
+constexpr auto hello = string_ref<"hello, world">{};
+static_assert(hello.size() == 12);
+static_assert(hello.splice<7, 12>() == "world");
+static_assert(hello.splice<7, 12>().splice<1, 3>() == string{"or"});
+static_assert(std::same_as<decltype(hello.splice<0, 5>().splice<1, 3>()), string_ref<"hello, world", 1, 3>>);
+static_assert((hello | splice<0, 5>) == hello.splice<0, 5>());
+static_assert((hello | splice<0, 5> | pad_left<2>) == "  hello");
+static_assert(pad_right<1>(hello.splice<0, 2>()) == "he ");
+static_assert(hello.splice<0, 5>().to_string() == string{"hello"});
+static_assert(string<8>{hello.splice<0, 5>()} == "hello  ");
+
+static_assert(split<string{"a,b,c"}, ','>().get<2>() == "c");
+static_assert(std::same_as<decltype(split<hello, ' '>().get<1>()), string_ref<"hello, world", 7, 12>>);
+static_assert(split<hello.splice<2, 12>(), 'o', 1>().get<0>() == "ll");
+static_assert(split<hello.splice<2, 12>(), 'o', 1>().get<1>() == ", world");
+static_assert(strip_leading_whitespace<hello.splice<6, 12>()>() == "world");
+
+constexpr auto many_fields = []() consteval {
+   string<2000> to_ret;
+   for (std::size_t i = 0; i < 1999; ++i) {
+      to_ret.value_[i] = i % 2 == 0 ? static_cast<char>('a' + i / 2 % 26) : ',';
+   }
+   return to_ret;
+}();
+static_assert(split<many_fields, ','>().size() == 1000);
+static_assert(split<many_fields, ','>()[999] == "l");
+
+bool check_runtime_split()
+{
+   const auto [key, value] = split<string{"name=value"}, '='>();
+   // volatile so the comparison isn't constant folded
+   volatile std::size_t index = 1;
+   return key == "name" && value == "value" && split<many_fields, ','>()[index] == "b";
+}
+
+int main() { return check_runtime_split() ? 0 : 1; }